@@ -0,0 +1,68 @@
+/*
+ * File:   adc.c
+ * Comments: ADC driver, owns the channel multiplexer and the conversion
+ *           clock for the RFID and light sensor paths
+ */
+
+#include <xc.h>
+#include "adc.h"
+#include "peripherials.h"
+
+volatile struct AdcState adc = {0, ADC_NONE, false, false};
+
+void initADC(void)
+{
+    //Right justified result, VDD/VSS reference
+    ADCON1 = 0b10000000;
+    ADCON0 = ADC_CON0(ADC_LIGHT);
+    adc.channel = ADC_LIGHT;
+    __delay_us(ADC_ACQUISITION_DELAY_US);
+}
+
+/**
+ * Connect a channel to the hold capacitor and let it charge
+ * @param channel
+ */
+static void adcSelect(uint8_t channel)
+{
+    if(adc.channel != channel){
+        ADCON0 = ADC_CON0(channel);
+        adc.channel = channel;
+        __delay_us(ADC_ACQUISITION_DELAY_US);
+    }else{
+        __delay_us(ADC_REPEAT_DELAY_US);
+    }
+}
+
+uint16_t adcRead(uint8_t channel)
+{
+    //Let a background conversion finish, its result is kept
+    while(adc.busy){}
+    adcSelect(channel);
+    ADCON0bits.GO_DONE = 1;
+    while(ADCON0bits.GO_DONE){}
+    uint16_t ret = ADRESL;
+    ret |= ((uint16_t)(ADRESH & 0x3) << 8);
+    return ret;
+}
+
+void adcStart(uint8_t channel)
+{
+    while(adc.busy){}
+    adcSelect(channel);
+    adc.ready = false;
+    adc.busy = true;
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+    ADCON0bits.GO_DONE = 1;
+}
+
+bool adcResult(uint16_t* value)
+{
+    if(!adc.ready){
+        return false;
+    }
+    *value = adc.result;
+    adc.ready = false;
+    return true;
+}
@@ -0,0 +1,81 @@
+/* 
+ * File:   adc.h
+ * Comments: ADC driver, owns the channel multiplexer and the conversion
+ *           clock for the RFID and light sensor paths
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef ADC_INCLUDED_H
+#define	ADC_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+
+// Analog channels
+#define ADC_LIGHT 0     // AN0, light sensor
+#define ADC_RFID 2      // AN2, RFID demodulator
+#define ADC_NONE 0xFF   // No channel acquired yet
+
+// Fastest conversion clock giving TAD >= 1.6us (PIC16F886 datasheet, table 9-1)
+// 19.6 MHz crystal: Fosc/32 -> TAD = 1.63us, a conversion is about 19us and a
+// repeated RFID sample about 23us with ADC_REPEAT_DELAY_US (21us at the out of
+// spec Fosc/2 clock used before, acquisition included)
+#if _XTAL_FREQ <= 1250000UL
+#define ADC_ADCS 0x0    // Fosc/2
+#elif _XTAL_FREQ <= 5000000UL
+#define ADC_ADCS 0x1    // Fosc/8
+#elif _XTAL_FREQ <= 20000000UL
+#define ADC_ADCS 0x2    // Fosc/32
+#else
+#define ADC_ADCS 0x3    // FRC
+#endif
+
+// ADCON0 value selecting a channel, ADC on
+#define ADC_CON0(channel) ((uint8_t)((ADC_ADCS << 6) | ((channel) << 2) | 0x1))
+
+// ADC acquisition time as per PIC16F886 datasheet (20µs minimum)
+// Only needed when the channel changes
+#define ADC_ACQUISITION_DELAY_US 20
+// Wait between two conversions on the same channel (2 TAD minimum)
+#define ADC_REPEAT_DELAY_US 4
+
+// Conversion state shared with the interrupt
+struct AdcState{
+    uint16_t result;    //Last interrupt completed conversion
+    uint8_t channel;    //Channel connected to the hold capacitor
+    bool busy;          //Interrupt completed conversion running
+    bool ready;         //result not read yet
+};
+extern volatile struct AdcState adc;
+
+/**
+ * Configure the ADC (right justified, VDD/VSS reference) and turn it on
+ */
+void initADC(void);
+
+/**
+ * Convert a channel, waiting for the result
+ * The acquisition delay is only spent when the channel changes
+ * Waits for a running interrupt completed conversion first
+ * @param channel ADC_LIGHT or ADC_RFID
+ * @return 10 bit result
+ */
+uint16_t adcRead(uint8_t channel);
+
+/**
+ * Start a conversion completed by the ADC interrupt
+ * @param channel ADC_LIGHT or ADC_RFID
+ */
+void adcStart(uint8_t channel);
+
+/**
+ * Get the result of the conversion started by adcStart()
+ * @param value Result
+ * @return true if a new result was available
+ */
+bool adcResult(uint16_t* value);
+
+#endif	/* ADC_INCLUDED_H */
@@ -26,6 +26,15 @@ SOURCE_FILES=(
     "rfid.c"
     "peripherials.c"
     "cat.c"
+    "power.c"
+    "light.c"
+    "adc.c"
+    "timer.c"
+    "rtc.c"
+    "mode.c"
+    "config.c"
+    "frame.c"
+    "command.c"
 )
 
 # Create output directories
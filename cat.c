@@ -10,13 +10,21 @@
 #include "cat.h"
 #include "peripherials.h"
 
+//Slots holding a cat
+static uint16_t storedCats = 0;
+//Cats known to be inside
+static uint16_t homeCats = 0;
+//Occupancy not yet written to EEPROM
+static bool homeDirty = false;
+//Time of the last occupancy change
+static ms_t homeChanged = 0;
 
 uint16_t getConfiguration(uint8_t cfg)
 {
     uint16_t ret = 0;
-    uint8_t offset = cfg*2;
-    //Ensure we read the configuration area
-    if(offset<CAT_OFFSET){        
+    //Ensure we read the configuration area, cfg*2 wraps above 127
+    if(cfg<CFG_WORDS){
+        uint8_t offset = cfg*2;
         ret = eeprom_read(offset);
         ret |= (eeprom_read(offset+1)<<8);
     }
@@ -25,9 +33,9 @@ uint16_t getConfiguration(uint8_t cfg)
 
 void setConfiguration(uint8_t cfg, uint16_t value)
 {
-    uint8_t offset = cfg*2;
-    //Ensure we write in the configuration area
-    if(offset<CAT_OFFSET){
+    //Ensure we write in the configuration area, cfg*2 wraps above 127
+    if(cfg<CFG_WORDS){
+        uint8_t offset = cfg*2;
         // Read current value to avoid unnecessary EEPROM writes (100k cycle limit)
         uint16_t currentValue = eeprom_read(offset);
         currentValue |= (eeprom_read(offset+1)<<8);
@@ -86,6 +94,7 @@ uint8_t saveCat(Cat* cat)
                     eeprom_write(j+offset, cat->id[j]);
                 }
             }
+            storedCats |= (1U << i);
             return i+1;
         }else if(tCrc == cat->crc){
             //Already stored
@@ -102,6 +111,11 @@ uint8_t saveCat(Cat* cat)
  * @return 
  */
 bool catExists(Cat* cat, const uint16_t* otherCrc)
+{
+    return findCat(cat, otherCrc) != 0;
+}
+
+uint8_t findCat(Cat* cat, const uint16_t* otherCrc)
 {
     uint8_t offset = CAT_OFFSET;
     for(uint8_t i=0;i<CAT_SLOTS;++i){
@@ -113,11 +127,11 @@ bool catExists(Cat* cat, const uint16_t* otherCrc)
             for(uint8_t j=0;j<6;++j){
                 cat->id[j] = eeprom_read(j+offset);
             }
-            return true;
+            return i+1;
         }
-        offset = CAT_OFFSET + i*sizeof(Cat);
+        offset += sizeof(Cat);
     }
-    return false;
+    return 0;
 }
 
 /**
@@ -136,8 +150,74 @@ void clearCats(void)
         }
         offset += sizeof(Cat);
     }
+    storedCats = 0;
+    setHomeCats(0);
     for(uint8_t i=0;i<5;++i){
         beep();
         __delay_ms(100);
     }
-}
\ No newline at end of file
+}
+
+void initOccupancy(void)
+{
+    uint8_t offset = CAT_OFFSET;
+    storedCats = 0;
+    for(uint8_t i=0;i<CAT_SLOTS;++i){
+        if((eeprom_read(offset) != 0x0) || (eeprom_read(offset+1) != 0x0)){
+            storedCats |= (1U << i);
+        }
+        offset += sizeof(Cat);
+    }
+    uint16_t home = getConfiguration(HOME_CFG);
+    //Unprogrammed EEPROM, nobody is known inside
+    if(home == 0xFFFF){
+        home = 0;
+    }
+    homeCats = home & storedCats;
+    homeDirty = false;
+}
+
+uint16_t getStoredCats(void)
+{
+    return storedCats;
+}
+
+uint16_t getHomeCats(void)
+{
+    return homeCats;
+}
+
+void setHomeCats(uint16_t home)
+{
+    home &= storedCats;
+    if(home != homeCats){
+        homeCats = home;
+        homeDirty = true;
+        homeChanged = millis();
+    }
+}
+
+void catEntered(uint8_t slot)
+{
+    if((slot > 0) && (slot <= CAT_SLOTS)){
+        setHomeCats(homeCats | (1U << (slot-1)));
+    }
+}
+
+void catLeft(void)
+{
+    setHomeCats(0);
+}
+
+bool allCatsHome(void)
+{
+    return (storedCats != 0) && (homeCats == storedCats);
+}
+
+void saveOccupancy(void)
+{
+    if(homeDirty && ((millis()-homeChanged) >= HOME_SAVE_DELAY)){
+        setConfiguration(HOME_CFG, homeCats);
+        homeDirty = false;
+    }
+}
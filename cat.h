@@ -34,6 +34,7 @@
 #include <xc.h> // include processor files - each processor file is guarded.  
 #include <stdint.h>
 #include <stdbool.h>
+#include "interrupts.h"
 
 //Keep first 128 bytes for global settings
 #define CAT_OFFSET 128
@@ -43,6 +44,57 @@
 //Offset of configuration
 //Light threshold value
 #define LIGHT_CFG 0
+//Sleep when idle (1 enables). 1 and 2 were the flap position settings
+#define IDLE_CFG 3
+//Fastest RFID poll interval in ms (0 selects the default)
+#define POLL_MIN_CFG 4
+//Slowest RFID poll interval in ms (0 selects the default)
+#define POLL_MAX_CFG 5
+//Cats known to be inside, one bit per slot
+#define HOME_CFG 6
+//Light hysteresis to leave night mode (ADC counts)
+#define LIGHT_HYST_CFG 7
+//Time the light must stay past a limit to switch night mode (s)
+#define LIGHT_DWELL_CFG 8
+//Clock drift correction in ppm (signed, positive when the tick is fast, -1 is refused)
+#define RTC_DRIFT_CFG 9
+//Maximum time the entrance stays unlocked (ms)
+#define OPEN_TIME_CFG 10
+//Time between two light sensor reads (ms)
+#define LIGHT_PERIOD_CFG 11
+//Latch solenoid pulse (ms)
+#define LATCH_PULSE_CFG 12
+//RFID demodulated bit threshold (ADC counts)
+#define RFID_BIT_CFG 13
+//RFID carrier threshold (ADC counts)
+#define RFID_CARRIER_CFG 14
+//Serial command byte timeout (ms)
+#define SERIAL_TIMEOUT_CFG 15
+//First of the SCHEDULE_ENTRIES mode change entries (see rtc.h)
+#define SCHEDULE_CFG 16
+//Green hold to enter learn mode (ms)
+#define LEARN_HOLD_CFG 24
+//Red hold to toggle vet mode (ms)
+#define VET_HOLD_CFG 25
+//Red press to toggle night mode (ms)
+#define NIGHT_PRESS_CFG 26
+//Both buttons hold to clear all cats (ms)
+#define CLEAR_HOLD_CFG 27
+//Delay before relocking once the flap was passed (ms)
+#define RELOCK_DELAY_CFG 28
+//Serial output on a full transmit ring (0 waits, 1 drops, see serial.h)
+#define TX_POLICY_CFG 29
+//Reply protocol (0 text, 1 SLIP framed binary, see serial.h)
+#define PROTO_CFG 30
+//RTS flow control on the serial header RC5 (1 enables, see serial.h)
+#define FLOW_CFG 31
+//Serial output classes sent (OUT_* bits, see serial.h)
+#define OUTPUT_CFG 32
+//Number of configuration words before the cat slots
+#define CFG_WORDS (CAT_OFFSET/2)
+
+//Time an occupancy change is held in RAM before it is written to EEPROM
+#define HOME_SAVE_DELAY 60000
 
 /**
  Define a cat in the 
@@ -85,6 +137,65 @@ uint8_t saveCat(Cat* cat);
  */
 bool catExists(Cat* cat, const uint16_t* otherCrc);
 
+/**
+ * Locate a cat by it's CRC
+ * @param cat cat structure
+ * @param otherCrc Second CRC to be checked
+ * @return Slot number (1 based) or 0 if not found
+ */
+uint8_t findCat(Cat* cat, const uint16_t* otherCrc);
+
+/**
+ * Load the stored slots and the occupancy saved in EEPROM
+ */
+void initOccupancy(void);
+
+/**
+ * Get the used slots
+ * @return One bit per slot holding a cat
+ */
+uint16_t getStoredCats(void);
+
+/**
+ * Get the cats known to be inside
+ * A cat is known inside once it was accepted and passed the flap, and
+ * until the flap is passed in the other direction by an unknown cat.
+ * @return One bit per slot
+ */
+uint16_t getHomeCats(void);
+
+/**
+ * Override the occupancy, e.g. from the host
+ * @param home One bit per slot, unused slots are ignored
+ */
+void setHomeCats(uint16_t home);
+
+/**
+ * An accepted cat passed the flap
+ * @param slot Slot number (1 based) as returned by findCat()
+ */
+void catEntered(uint8_t slot);
+
+/**
+ * The flap was passed without an accept
+ * The cat cannot be identified, so no cat is known inside anymore.
+ * Clearing all is the safe side: a cat wrongly known inside would keep
+ * the RFID poll at the slow all home rate while it waits outside.
+ */
+void catLeft(void);
+
+/**
+ * Check if every stored cat is known to be inside
+ * @return false if no cat is stored
+ */
+bool allCatsHome(void);
+
+/**
+ * Write the occupancy to EEPROM once it was stable for HOME_SAVE_DELAY
+ * Called from the main loop
+ */
+void saveOccupancy(void);
+
 /**
  * Clear all cats in the EEPROM memory
  */
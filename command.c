@@ -0,0 +1,112 @@
+/*
+ * File:   command.c
+ * Comments: Serial command parser, splits the received bytes into
+ *           commands and their parameters
+ */
+
+#include <xc.h>
+#include <stddef.h>
+#include "command.h"
+#include "timer.h"
+
+struct CommandParser cmdParser;
+uint8_t cmdBatch[CFG_BATCH*3];
+
+const char* commandName(uint8_t cmd)
+{
+    switch(cmd){
+        case 'S':
+            return "Status request";
+        case 'T':
+            return "Statistics request";
+        case 'L':
+            return "Learn progress";
+        case 'O':
+            return "Occupancy";
+        case 'K':
+            return "Clock";
+        case 'C':
+            return "Configuration";
+        case 'G':
+            return "Configuration batch";
+        case 'M':
+            return "Mode change";
+        case 'B':
+            return "Auto-baud";
+        case 'P':
+            return "Telemetry";
+        default:
+            return NULL;
+    }
+}
+
+uint8_t commandLength(uint8_t cmd, const uint8_t* args, uint8_t len)
+{
+    bool set = (len > 0) && (args[0] == 'S');
+    switch(cmd){
+        case 'O':
+            return set ? 3 : 1;
+        case 'K':
+            return set ? 5 : 1;
+        case 'C':
+            return set ? 4 : 2;
+        case 'G':
+            //Entries follow the count, a bad count ends the command
+            if(!set){
+                return 3;
+            }
+            if((len < 2) || (args[1] == 0) || (args[1] > CFG_BATCH)){
+                return 2;
+            }
+            return (uint8_t)(2 + args[1]*3);
+        case 'M':
+            return 1;
+        case 'P':
+            return 2;
+        default:
+            return 0;
+    }
+}
+
+uint8_t parseByte(uint8_t b)
+{
+    uint8_t result = 0;
+    switch(cmdParser.state){
+        case CMD_STATE_SEQ:
+            //Sequence number, the command follows
+            cmdParser.seq = b;
+            cmdParser.state = CMD_STATE_TAGGED;
+            timerStart(TIMER_SERIAL, configValue(SERIAL_TIMEOUT_CFG), false);
+            return 0;
+        case CMD_STATE_ARGS:
+            if((cmdParser.cmd == 'G') && (cmdParser.args[0] == 'S') && (cmdParser.len >= 2)){
+                cmdBatch[cmdParser.len-2] = b;
+            }else{
+                cmdParser.args[cmdParser.len] = b;
+            }
+            ++cmdParser.len;
+            break;
+        default:
+            if((b == CMD_SEQ) && (cmdParser.state == CMD_STATE_IDLE)){
+                cmdParser.state = CMD_STATE_SEQ;
+                timerStart(TIMER_SERIAL, configValue(SERIAL_TIMEOUT_CFG), false);
+                return 0;
+            }
+            cmdParser.tagged = (cmdParser.state == CMD_STATE_TAGGED);
+            cmdParser.state = CMD_STATE_IDLE;
+            if(commandName(b) == NULL){
+                return PARSE_COMMAND | PARSE_UNKNOWN;
+            }
+            cmdParser.cmd = b;
+            cmdParser.len = 0;
+            result = PARSE_COMMAND;
+    }
+    if(cmdParser.len < commandLength(cmdParser.cmd, cmdParser.args, cmdParser.len)){
+        //Wait for the next parameter
+        cmdParser.state = CMD_STATE_ARGS;
+        timerStart(TIMER_SERIAL, configValue(SERIAL_TIMEOUT_CFG), false);
+        return result;
+    }
+    cmdParser.state = CMD_STATE_IDLE;
+    return result | PARSE_READY;
+}
@@ -0,0 +1,72 @@
+/*
+ * File:   command.h
+ * Comments: Serial command parser, splits the received bytes into
+ *           commands and their parameters
+ * Revision history:
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.
+#ifndef COMMAND_INCLUDED_H
+#define	COMMAND_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+#define CMD_STATE_IDLE 0
+#define CMD_STATE_ARGS 1
+#define CMD_STATE_SEQ 2
+#define CMD_STATE_TAGGED 3
+//Longest command parameters ('K' 'S' + 2 shorts)
+#define CMD_ARGS 5
+//Prefix of a sequenced command, followed by the sequence number
+#define CMD_SEQ '#'
+
+// parseByte() results
+#define PARSE_COMMAND 0x1   // The byte started a command
+#define PARSE_UNKNOWN 0x2   // The command is unknown and was dropped
+#define PARSE_READY 0x4     // cmdParser holds a complete command
+
+// Command being received across main loop passes
+struct CommandParser{
+    uint8_t state;          // CMD_STATE_*
+    uint8_t cmd;
+    uint8_t len;            // Parameters received
+    uint8_t args[CMD_ARGS];
+    uint8_t seq;            // Sequence number when tagged
+    bool tagged;
+};
+extern struct CommandParser cmdParser;
+
+// Entries of the batch configuration write being received ('G' 'S')
+extern uint8_t cmdBatch[CFG_BATCH*3];
+
+/**
+ * Name of a command, for the command trace
+ * @param cmd Command byte
+ * @return Name or NULL if the command is unknown
+ */
+const char* commandName(uint8_t cmd);
+
+/**
+ * Number of parameter bytes a command needs
+ * Grows once the R/S selector is known
+ * @param cmd Command byte
+ * @param args Parameters received so far
+ * @param len Number of parameters received
+ * @return Parameter count
+ */
+uint8_t commandLength(uint8_t cmd, const uint8_t* args, uint8_t len);
+
+/**
+ * Feed a received byte to the command parser
+ * Starts TIMER_SERIAL while more bytes are expected. 'G' 'S' entries go
+ * to cmdBatch, the other parameters to cmdParser.args.
+ * @param b Byte
+ * @return PARSE_* flags
+ */
+uint8_t parseByte(uint8_t b);
+
+#endif	/* COMMAND_INCLUDED_H */
@@ -0,0 +1,148 @@
+/*
+ * File:   config.c
+ * Comments: Registry of the tunable settings, with defaults and limits,
+ *           mirrored in RAM and persisted in EEPROM
+ */
+
+#include <xc.h>
+#include "config.h"
+#include "peripherials.h"
+#include "rfid.h"
+#include "serial.h"
+#include "light.h"
+#include "power.h"
+
+static const ConfigSetting settings[CFG_REGISTERED] = {
+    //index, flags, default, min, max
+    {LIGHT_CFG, 0, 512, 0, 1023},
+    {IDLE_CFG, 0, 0, 0, IDLE_SLEEP | IDLE_SLOW_CLOCK},
+    {POLL_MIN_CFG, 0, RFID_POLL_MIN, 1, 10000},
+    {POLL_MAX_CFG, 0, RFID_POLL_MAX, 1, 60000},
+    {LIGHT_HYST_CFG, 0, LIGHT_HYSTERESIS, 0, 1023},
+    {LIGHT_DWELL_CFG, 0, LIGHT_DWELL, 0, 3600},
+    {RTC_DRIFT_CFG, CFG_SIGNED, 0, (uint16_t)-1000, 1000},
+    {OPEN_TIME_CFG, 0, OPEN_TIME, 1000, 60000},
+    {LIGHT_PERIOD_CFG, 0, LIGHT_READ_PERIOD, 100, 60000},
+    {LATCH_PULSE_CFG, 0, LATCH_PULSE_TIME, 50, 2000},
+    {RFID_BIT_CFG, 0, RFID_ADC_THRESHOLD, 1, 1022},
+    {RFID_CARRIER_CFG, 0, RFID_CARRIER_THRESHOLD, 1, 1022},
+    {SERIAL_TIMEOUT_CFG, 0, SERIAL_TIMEOUT, 2, 1000},
+    {LEARN_HOLD_CFG, 0, BTN_LEARN_HOLD, 1000, 60000},
+    {VET_HOLD_CFG, 0, BTN_VET_HOLD, 1000, 60000},
+    {NIGHT_PRESS_CFG, 0, BTN_NIGHT_PRESS, 100, 60000},
+    {CLEAR_HOLD_CFG, 0, BTN_CLEAR_HOLD, 1000, 60000},
+    {RELOCK_DELAY_CFG, 0, RELOCK_DELAY, 0, 10000},
+    {TX_POLICY_CFG, 0, TX_BLOCK, TX_BLOCK, TX_DROP},
+    {PROTO_CFG, 0, PROTO_TEXT, PROTO_TEXT, PROTO_BINARY},
+    {FLOW_CFG, 0, 0, 0, 1},
+    {OUTPUT_CFG, 0, OUT_ALL, 0, OUT_ALL},
+};
+
+//RAM mirror, in the order of settings
+static uint16_t values[CFG_REGISTERED];
+
+/**
+ * Locate a registered setting
+ * @param index Configuration index
+ * @return Position in settings or CFG_REGISTERED if not registered
+ */
+static uint8_t findSetting(uint8_t index)
+{
+    uint8_t i = 0;
+    while((i < CFG_REGISTERED) && (settings[i].index != index)){
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * Check a value against the limits of a setting
+ * @param s Setting
+ * @param value
+ * @return true if within limits
+ */
+static bool inRange(const ConfigSetting* s, uint16_t value)
+{
+    if(s->flags & CFG_SIGNED){
+        return (value != 0xFFFF) &&
+                ((int16_t)value >= (int16_t)s->min) && ((int16_t)value <= (int16_t)s->max);
+    }
+    return (value >= s->min) && (value <= s->max);
+}
+
+void initConfig(void)
+{
+    for(uint8_t i=0;i<CFG_REGISTERED;++i){
+        uint16_t value = getConfiguration(settings[i].index);
+        //0xFFFF is unprogrammed EEPROM, even for signed settings
+        if((value == 0xFFFF) || !inRange(&settings[i], value)){
+            value = settings[i].def;
+        }
+        values[i] = value;
+    }
+}
+
+uint16_t configValue(uint8_t index)
+{
+    uint8_t i = findSetting(index);
+    if(i < CFG_REGISTERED){
+        return values[i];
+    }
+    return getConfiguration(index);
+}
+
+/**
+ * Check an index and value before storing them
+ * @param index Configuration index
+ * @param value
+ * @return false outside of the configuration area or the setting limits
+ */
+static bool validValue(uint8_t index, uint16_t value)
+{
+    uint8_t i = findSetting(index);
+    if(index >= CFG_WORDS){
+        return false;
+    }
+    return (i >= CFG_REGISTERED) || inRange(&settings[i], value);
+}
+
+bool setConfigValue(uint8_t index, uint16_t value)
+{
+    uint8_t i = findSetting(index);
+    if(!validValue(index, value)){
+        return false;
+    }
+    if(i < CFG_REGISTERED){
+        values[i] = value;
+    }
+    setConfiguration(index, value);
+    return true;
+}
+
+bool setConfigValues(const uint8_t* pairs, uint8_t count, uint8_t* failed)
+{
+    //Check everything before the first EEPROM write
+    for(uint8_t i=0;i<count;++i){
+        const uint8_t* p = &pairs[i*3];
+        if(!validValue(p[0], p[1] | ((uint16_t)p[2] << 8))){
+            *failed = i;
+            return false;
+        }
+    }
+    for(uint8_t i=0;i<count;++i){
+        const uint8_t* p = &pairs[i*3];
+        setConfigValue(p[0], p[1] | ((uint16_t)p[2] << 8));
+    }
+    return true;
+}
+
+bool configLimits(uint8_t index, uint16_t* min, uint16_t* max)
+{
+    uint8_t i = findSetting(index);
+    if(i >= CFG_REGISTERED){
+        return false;
+    }
+    *min = settings[i].min;
+    *max = settings[i].max;
+    return true;
+}
@@ -0,0 +1,80 @@
+/* 
+ * File:   config.h
+ * Comments: Registry of the tunable settings, with defaults and limits,
+ *           mirrored in RAM and persisted in EEPROM
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef CONFIG_INCLUDED_H
+#define	CONFIG_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+#include "cat.h"
+
+// Setting flags
+// min, max and value are int16_t. -1 is refused, it is stored as 0xFFFF
+// and would read back as unprogrammed
+#define CFG_SIGNED 0x1
+
+// A registered setting
+typedef struct{
+    uint8_t index;      //Configuration index (*_CFG in cat.h)
+    uint8_t flags;      //CFG_* flags
+    uint16_t def;       //Used when EEPROM is unprogrammed or out of range
+    uint16_t min;
+    uint16_t max;
+}ConfigSetting;
+
+// Number of registered settings
+#define CFG_REGISTERED 22
+// Most settings changed by one batch, 3 bytes each (index, value LSB first)
+#define CFG_BATCH 8
+
+/**
+ * Load all registered settings from EEPROM
+ * Unprogrammed (0xFFFF) or out of range values are replaced by their default
+ */
+void initConfig(void);
+
+/**
+ * Get a setting
+ * Registered settings come from RAM, others are read from EEPROM
+ * @param index Configuration index
+ * @return Value
+ */
+uint16_t configValue(uint8_t index);
+
+/**
+ * Validate and store a setting
+ * @param index Configuration index
+ * @param value New value
+ * @return false if the index is outside of the configuration area or the
+ *         value outside of the setting limits
+ */
+bool setConfigValue(uint8_t index, uint16_t value);
+
+/**
+ * Validate and store several settings at once
+ * Nothing is written unless every value is valid
+ * @param pairs count entries of index u8 and value u16 (LSB first)
+ * @param count Number of entries, at most CFG_BATCH
+ * @param failed Set to the first refused entry
+ * @return false if an index is outside of the configuration area or a
+ *         value outside of its limits
+ */
+bool setConfigValues(const uint8_t* pairs, uint8_t count, uint8_t* failed);
+
+/**
+ * Get the limits of a setting
+ * @param index Configuration index
+ * @param min Minimum value
+ * @param max Maximum value
+ * @return false if the setting is not registered (no limits)
+ */
+bool configLimits(uint8_t index, uint16_t* min, uint16_t* max);
+
+#endif	/* CONFIG_INCLUDED_H */
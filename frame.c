@@ -0,0 +1,79 @@
+/*
+ * File:   frame.c
+ * Comments: Binary protocol, SLIP framed messages with a type, a sequence
+ *           number and a CRC
+ */
+
+#include <xc.h>
+#include "frame.h"
+#include "serial.h"
+
+//Sequence number of the next frame
+static uint8_t frameSeq = 0;
+//CRC of the frame being sent
+static uint16_t frameCrcValue = FRAME_CRC_INIT;
+
+uint16_t frameCrc(uint16_t crc, uint8_t v)
+{
+    crc ^= (uint16_t)v << 8;
+    for(uint8_t i=0;i<8;++i){
+        if(crc & 0x8000){
+            crc = (crc << 1) ^ FRAME_CRC_POLY;
+        }else{
+            crc <<= 1;
+        }
+    }
+    return crc;
+}
+
+/**
+ * Send a byte, escaped
+ * @param v Byte
+ */
+static void slipPut(uint8_t v)
+{
+    if(v == SLIP_END){
+        putRaw(SLIP_ESC);
+        putRaw(SLIP_ESC_END);
+    }else if(v == SLIP_ESC){
+        putRaw(SLIP_ESC);
+        putRaw(SLIP_ESC_ESC);
+    }else{
+        putRaw(v);
+    }
+}
+
+void frameBegin(uint8_t type)
+{
+    //Leading END flushes any line noise at the receiver
+    putRaw(SLIP_END);
+    frameCrcValue = FRAME_CRC_INIT;
+    framePut(type);
+    framePut(frameSeq++);
+}
+
+void framePut(uint8_t v)
+{
+    frameCrcValue = frameCrc(frameCrcValue, v);
+    slipPut(v);
+}
+
+void framePutShort(uint16_t v)
+{
+    framePut((uint8_t)v);
+    framePut((uint8_t)(v >> 8));
+}
+
+void framePutLong(uint32_t v)
+{
+    framePutShort((uint16_t)v);
+    framePutShort((uint16_t)(v >> 16));
+}
+
+void frameEnd(void)
+{
+    uint16_t crc = frameCrcValue;
+    slipPut((uint8_t)crc);
+    slipPut((uint8_t)(crc >> 8));
+    putRaw(SLIP_END);
+}
@@ -0,0 +1,108 @@
+/* 
+ * File:   frame.h
+ * Comments: Binary protocol, SLIP framed messages with a type, a sequence
+ *           number and a CRC
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef FRAME_INCLUDED_H
+#define	FRAME_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * A frame is END type seq payload crc END
+ * Multi-byte fields are little endian (LSB first, like putShort).
+ * The CRC (CRC-16/CCITT-FALSE) covers type, seq and payload and is
+ * computed before SLIP escaping.
+ */
+
+// SLIP special characters (RFC 1055)
+#define SLIP_END 0xC0
+#define SLIP_ESC 0xDB
+#define SLIP_ESC_END 0xDC
+#define SLIP_ESC_ESC 0xDD
+
+// CRC-16/CCITT-FALSE
+#define FRAME_CRC_INIT 0xFFFF
+#define FRAME_CRC_POLY 0x1021
+
+// Message types
+#define FRAME_STATUS 0x01       // mode u8, light u16, status u16, poll u16
+#define FRAME_CAT 0x02          // id[6], crc u16, time u32
+#define FRAME_CONFIG 0x03       // index u8, value u16
+#define FRAME_STATS 0x04        // see printStats()
+#define FRAME_MODE 0x05         // mode u8
+#define FRAME_OCCUPANCY 0x06    // home u16, stored u16, all home u8
+#define FRAME_CLOCK 0x07        // time u32, valid u8, drift s16
+#define FRAME_LEARN 0x08        // active u8, remaining u16
+#define FRAME_BAUD 0x09         // rate u32, divider u16, rate 0 while measuring
+#define FRAME_TELEMETRY 0x0A    // fields u8, then the TLM_* fields present, 0 when stopped
+#define FRAME_ACK 0x0B          // seq u8, sequenced command queued
+#define FRAME_DONE 0x0C         // seq u8, sequenced command completed
+#define FRAME_CONFIGS 0x0D      // count u8, then index u8, value u16 each
+#define FRAME_LEARN_EVENT 0x0E  // event u8 (LEARN_*), slot u8
+#define FRAME_SCHEDULE 0x0F     // mode u8, minute of day u16
+#define FRAME_ERROR 0x7F        // code u8, then min u16, max u16 (, index u8) for ERR_RANGE
+
+// Telemetry fields, in the order they are sent
+#define TLM_MODE 0x01           // mode u8
+#define TLM_STATUS 0x02         // status bits u16 (latches)
+#define TLM_NIGHT 0x04          // night u8
+#define TLM_HOME 0x08           // cats inside u16
+#define TLM_LIGHT 0x10          // light u16
+#define TLM_POLL 0x20           // RFID poll interval u16
+#define TLM_ALL 0x3F
+// Fields pushed as soon as they change, the others once per period
+#define TLM_EVENTS (TLM_MODE | TLM_STATUS | TLM_NIGHT | TLM_HOME)
+
+// Error codes of FRAME_ERROR
+#define ERR_TIMEOUT 1           // Command parameter not received
+#define ERR_RANGE 2             // Configuration value out of range
+#define ERR_MODE 3              // Invalid mode
+#define ERR_UNKNOWN 4           // Unknown command
+#define ERR_BUSY 5              // Command queue full
+#define ERR_BATCH_BUSY 6        // Sequenced batch write sent while commands are queued
+
+/**
+ * Start a frame
+ * @param type FRAME_* message type
+ */
+void frameBegin(uint8_t type);
+
+/**
+ * Add a byte to the current frame
+ * @param v Value
+ */
+void framePut(uint8_t v);
+
+/**
+ * Add a 16-bit value to the current frame
+ * @param v Value
+ */
+void framePutShort(uint16_t v);
+
+/**
+ * Add a 32-bit value to the current frame
+ * @param v Value
+ */
+void framePutLong(uint32_t v);
+
+/**
+ * Send the CRC and close the current frame
+ */
+void frameEnd(void);
+
+/**
+ * Update a CRC-16/CCITT-FALSE with one byte
+ * @param crc Current CRC (FRAME_CRC_INIT for the first byte)
+ * @param v Byte
+ * @return New CRC
+ */
+uint16_t frameCrc(uint16_t crc, uint8_t v);
+
+#endif	/* FRAME_INCLUDED_H */
@@ -5,19 +5,97 @@
 #include "interrupts.h"
 #include "serial.h"
 #include "peripherials.h"
+#include "power.h"
+#include "adc.h"
+#include "timer.h"
 
 /******************************************************************************/
 /* Interrupt Routines                                                         */
 /******************************************************************************/
 static volatile ms_t millisValue=0;
+volatile uint16_t tmr1Period = TMR1_PERIOD;
+
+/**
+ * Queue a debounced button change (ISR only)
+ * @param button BTN_GREEN or BTN_RED
+ * @param pressed New button state
+ */
+static void queueButton(uint8_t button, bool pressed)
+{
+    uint8_t next = (buttons.rIndex + 1) & (BTN_QUEUE - 1);
+    if(pressed){
+        buttons.held |= button;
+    }else{
+        buttons.held &= ~button;
+        button |= BTN_RELEASE;
+    }
+    //Queue full, drop the event. Held state stays correct
+    if(next != buttons.uIndex){
+        buttons.events[buttons.rIndex].time = buttons.changedAt;
+        buttons.events[buttons.rIndex].event = button;
+        buttons.rIndex = next;
+    }
+}
 
 void __interrupt () isr(void)
 {
-    if(TMR1IF && TMR1IE){
-        TMR1H = TMR1_H_PRES;             // preset for timer1 MSB register
-        TMR1L = TMR1_L_PRES;             // preset for timer1 LSB register        
-        TMR1IF = 0;
+    if(CCP2IF && CCP2IE){
+        //Next tick one period after this one, not after the ISR entry
+        uint16_t next = (((uint16_t)CCPR2H << 8) | CCPR2L) + tmr1Period;
+        CCPR2L = (uint8_t)next;
+        CCPR2H = (uint8_t)(next >> 8);
+        CCP2IF = 0;
         ++millisValue;
+        tickTimers(1);
+        //Buttons are also sampled here, as a read-modify-write of
+        //PORTB (LEDs) can swallow an interrupt-on-change mismatch
+        uint8_t pressed = 0;
+        if(!GREEN_BTN){ pressed |= BTN_GREEN; }
+        if(!RED_BTN){ pressed |= BTN_RED; }
+        if(!buttons.pending){
+            if(pressed != buttons.held){
+                buttons.changedAt = millisValue;
+                buttons.pending = true;
+            }
+        }else if((uint16_t)((uint16_t)millisValue - (uint16_t)buttons.changedAt) >= BTN_DEBOUNCE_MS){
+            //Buttons settled, report what changed since the first edge
+            buttons.pending = false;
+            uint8_t changed = pressed ^ buttons.held;
+            if(changed & BTN_GREEN){
+                queueButton(BTN_GREEN, (pressed & BTN_GREEN) != 0);
+            }
+            if(changed & BTN_RED){
+                queueButton(BTN_RED, (pressed & BTN_RED) != 0);
+            }
+        }
+    }else if(RBIF && RBIE){
+        //Button edge, timestamp it. Reading PORTB ends the mismatch
+        uint8_t portb = PORTB;
+        (void)portb;
+        RBIF = 0;
+        if(!buttons.pending){
+            buttons.changedAt = millisValue;
+            buttons.pending = true;
+        }
+    }else if(INTF && INTE){
+        //Door switch edge, arm the opposite edge for next time
+        bool level = DOOR_SWITCH;
+        OPTION_REGbits.INTEDG = !level;
+        INTF = 0;
+        if(level != DOOR_CLOSED_LEVEL){
+            //Flap swung, ignore bounce right after it came back
+            if(!door.open && ((millisValue - door.closedAt) >= DOOR_DEBOUNCE_MS)){
+                door.open = true;
+                door.swungAt = millisValue;
+            }
+        }else if(door.open){
+            //Flap back at rest, a very short swing is only bounce
+            door.open = false;
+            if((millisValue - door.swungAt) >= DOOR_DEBOUNCE_MS){
+                door.closedAt = millisValue;
+                ++door.passages;
+            }
+        }
     }else if(RCIF){
         // Check for UART errors before reading data
         if(RCSTAbits.FERR){
@@ -41,10 +119,7 @@ void __interrupt () isr(void)
             }
         }else{
             // No errors - read data into buffer
-            uint8_t nextIndex = rxBuffer.rIndex + 1;
-            if(nextIndex == SER_BUFFER){
-                nextIndex = 0;
-            }
+            uint8_t nextIndex = (rxBuffer.rIndex + 1) & (SER_BUFFER - 1);
             
             // Check if buffer would overflow
             if(nextIndex == rxBuffer.uIndex){
@@ -57,13 +132,66 @@ void __interrupt () isr(void)
                 // Buffer has space - store the byte
                 rxBuffer.buffer[rxBuffer.rIndex] = RCREG;
                 rxBuffer.rIndex = nextIndex;
+                // Ask the host to pause before the buffer overflows
+                if(rxBuffer.rts && (((nextIndex - rxBuffer.uIndex) & (SER_BUFFER - 1)) >= RX_RTS_HIGH)){
+                    SER_INT = 1;
+                }
             }
         }
         RCIF = 0;
+    }else if(TXIF && TXIE){
+        //Transmit ring, stop the interrupt once empty
+        if(txBuffer.rIndex != txBuffer.wIndex){
+            TXREG = txBuffer.buffer[txBuffer.rIndex];
+            txBuffer.rIndex = (txBuffer.rIndex + 1) & (TX_BUFFER - 1);
+        }
+        if(txBuffer.rIndex == txBuffer.wIndex){
+            TXIE = 0;
+        }
+    }else if(ADIF && ADIE){
+        //Background conversion done, one at a time
+        adc.result = ((uint16_t)(ADRESH & 0x3) << 8) | ADRESL;
+        adc.ready = true;
+        adc.busy = false;
+        ADIE = 0;
+        ADIF = 0;
     }
 }
 
 ms_t millis(void)
 {
-    return millisValue;
+    ms_t ret;
+    //The tick may fire between the byte reads, read until stable
+    do{
+        ret = millisValue;
+    }while(ret != millisValue);
+    return ret;
+}
+
+uint32_t micros(void)
+{
+    ms_t ms;
+    uint8_t high;
+    uint8_t low;
+    uint16_t compare;
+    do{
+        ms = millisValue;
+        //Timer 1 runs, re-read the low byte if the high byte moved
+        do{
+            high = TMR1H;
+            low = TMR1L;
+        }while(high != TMR1H);
+        compare = ((uint16_t)CCPR2H << 8) | CCPR2L;
+    }while(ms != millisValue);
+    //Counts since the last tick
+    uint16_t counts = (((uint16_t)high << 8) | low) - (uint16_t)(compare - tmr1Period);
+    return (ms * 1000UL) + ((uint32_t)counts * 1000UL / tmr1Period);
+}
+
+void addMillis(ms_t ms)
+{
+    CCP2IE = 0;
+    millisValue += ms;
+    tickTimers((ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms);
+    CCP2IE = 1;
 }
@@ -36,7 +36,30 @@
 
 typedef uint32_t ms_t;
 
+//Timer 1 counts per millisecond at the current clock
+extern volatile uint16_t tmr1Period;
+
+/**
+ * Get the milliseconds since boot
+ * Safe against the tick interrupt updating the counter mid-read
+ * @return Milliseconds
+ */
 ms_t millis(void);
 
+/**
+ * Get the microseconds since boot, for profiling
+ * Resolution is one Timer 1 count (0.8us on the crystal)
+ * @return Microseconds, wraps every 71 minutes
+ */
+uint32_t micros(void);
+
+/**
+ * Advance the millisecond counter
+ * Used to account for time Timer 1 was stopped (Sleep)
+ * Software timers are advanced as well
+ * @param ms Milliseconds to add
+ */
+void addMillis(ms_t ms);
+
 #endif	/* INTERRUPTS_INCLUDED_H */
 
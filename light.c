@@ -0,0 +1,133 @@
+/*
+ * File:   light.c
+ * Comments: Filtered light sensing and day/night decision for night mode
+ */
+
+#include <xc.h>
+#include "light.h"
+#include "adc.h"
+#include "timer.h"
+
+//Average of the oversampled reads, scaled by 2^LIGHT_EMA_SHIFT
+static uint32_t lightAcc = 0;
+//Limits in oversampled counts
+static uint16_t nightAbove = 0;
+static uint16_t dayBelow = 0;
+static ms_t dwellTime = (ms_t)LIGHT_DWELL*1000;
+static ms_t readPeriod = LIGHT_READ_PERIOD;
+static bool night = false;
+//Time the filtered light went past the limit
+static ms_t pastLimitSince = 0;
+static bool pastLimit = false;
+//Oversampled read in progress, one conversion per main loop pass
+static bool reading = false;
+static uint8_t readCount = 0;
+static uint16_t readSum = 0;
+
+/**
+ * Sum LIGHT_OVERSAMPLE conversions
+ * @return Light with LIGHT_OVERSAMPLE_SHIFT extra bits
+ */
+static uint16_t readOversampled(void)
+{
+    uint16_t sum = 0;
+    for(uint8_t i=0;i<LIGHT_OVERSAMPLE;++i){
+        sum += adcRead(ADC_LIGHT);
+    }
+    return sum;
+}
+
+/**
+ * Update night from a new oversampled read
+ * @param fine Light with LIGHT_OVERSAMPLE_SHIFT extra bits
+ * @param now Time of the read
+ */
+static void filterLight(uint16_t fine, ms_t now)
+{
+    lightAcc = LIGHT_EMA(lightAcc, fine);
+    fine = (uint16_t)(lightAcc >> LIGHT_EMA_SHIFT);
+    bool past = night ? (fine < dayBelow) : (fine > nightAbove);
+    if(!past){
+        pastLimit = false;
+    }else if(!pastLimit){
+        pastLimit = true;
+        pastLimitSince = now;
+    }
+    if(pastLimit && ((now-pastLimitSince) >= dwellTime)){
+        night = !night;
+        pastLimit = false;
+    }
+}
+
+void initLight(void)
+{
+    uint16_t fine = readOversampled();
+    lightAcc = (uint32_t)fine << LIGHT_EMA_SHIFT;
+    //No dwell at boot, start in the current state
+    night = (fine > nightAbove);
+    timerStart(TIMER_LIGHT, readPeriod, true);
+}
+
+void setLightPeriod(ms_t period)
+{
+    readPeriod = period;
+    if(timerRunning(TIMER_LIGHT)){
+        timerStart(TIMER_LIGHT, readPeriod, true);
+    }
+}
+
+void setLightLimits(uint16_t threshold, uint16_t hysteresis, uint16_t dwell)
+{
+    if(hysteresis == 0xFFFF){
+        hysteresis = LIGHT_HYSTERESIS;
+    }
+    if(dwell == 0xFFFF){
+        dwell = LIGHT_DWELL;
+    }
+    if(threshold > 1023){
+        threshold = 1023;
+    }
+    if(hysteresis > threshold){
+        hysteresis = threshold;
+    }
+    nightAbove = threshold << LIGHT_OVERSAMPLE_SHIFT;
+    dayBelow = (threshold-hysteresis) << LIGHT_OVERSAMPLE_SHIFT;
+    dwellTime = (ms_t)dwell*1000;
+    pastLimit = false;
+}
+
+bool updateLight(void)
+{
+    uint16_t value;
+    if(reading){
+        //Collect the conversion completed by the interrupt
+        if(!adcResult(&value)){
+            return false;
+        }
+        readSum += value;
+        if(++readCount < LIGHT_OVERSAMPLE){
+            adcStart(ADC_LIGHT);
+            return false;
+        }
+        reading = false;
+        filterLight(readSum, millis());
+        return true;
+    }
+    if(timerExpired(TIMER_LIGHT)){
+        reading = true;
+        readCount = 0;
+        readSum = 0;
+        adcStart(ADC_LIGHT);
+    }
+    return false;
+}
+
+uint16_t getLight(void)
+{
+    return (uint16_t)(lightAcc >> (LIGHT_EMA_SHIFT + LIGHT_OVERSAMPLE_SHIFT));
+}
+
+bool isNight(void)
+{
+    return night;
+}
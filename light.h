@@ -0,0 +1,80 @@
+/* 
+ * File:   light.h
+ * Comments: Filtered light sensing and day/night decision for night mode
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef LIGHT_INCLUDED_H
+#define	LIGHT_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+#include "interrupts.h"
+
+// Number of milliseconds between light sensor reads
+#define LIGHT_READ_PERIOD 1000
+
+// Conversions summed per read, 16 samples add 2 bits of resolution
+// 16 * 1023 = 16368 still fits 14 bits
+#define LIGHT_OVERSAMPLE_SHIFT 4
+#define LIGHT_OVERSAMPLE (1 << LIGHT_OVERSAMPLE_SHIFT)
+
+// Exponential moving average weight, 1/8 of each new read
+// Time constant is about 8 reads (8s)
+#define LIGHT_EMA_SHIFT 3
+
+// Default hysteresis below the threshold to leave night (ADC counts)
+#define LIGHT_HYSTERESIS 5
+// Default time the filtered light must stay past a limit to switch (s)
+#define LIGHT_DWELL 30
+
+// Update an EMA accumulator holding the average scaled by 2^LIGHT_EMA_SHIFT
+#define LIGHT_EMA(acc, sample) ((acc) - ((acc) >> LIGHT_EMA_SHIFT) + (sample))
+
+/**
+ * Take the first read and seed the filter
+ */
+void initLight(void);
+
+/**
+ * Set the night limits
+ * More is darker. Night starts above threshold and ends below
+ * threshold - hysteresis, each after dwell seconds past the limit.
+ * 0xFFFF (unprogrammed) selects the default hysteresis or dwell
+ * @param threshold Night threshold (ADC counts)
+ * @param hysteresis Hysteresis (ADC counts)
+ * @param dwell Dwell time (s)
+ */
+void setLightLimits(uint16_t threshold, uint16_t hysteresis, uint16_t dwell);
+
+/**
+ * Set the time between two reads
+ * Restarts the read timer if the sensor is already running
+ * @param period Read period (ms)
+ */
+void setLightPeriod(ms_t period);
+
+/**
+ * Read the sensor every read period (LIGHT_READ_PERIOD by default) and update night
+ * A read is spread over LIGHT_OVERSAMPLE calls, one conversion each,
+ * completed by the ADC interrupt. Needs the crystal clock.
+ * @return true when a read completed
+ */
+bool updateLight(void);
+
+/**
+ * Get the filtered light
+ * @return Light in ADC counts (0-1023)
+ */
+uint16_t getLight(void);
+
+/**
+ * Check if it is night
+ * @return true once it was dark for the dwell time
+ */
+bool isNight(void);
+
+#endif	/* LIGHT_INCLUDED_H */
@@ -2,283 +2,971 @@
 
 #include <stdint.h>        /* For uint8_t definition */
 #include <stdbool.h>       /* For true/false definition */
+#include <stddef.h>        /* For NULL */
 
 #include "interrupts.h"
 #include "peripherials.h"
 #include "user.h"          /* User funct/params, such as InitApp */
 #include "serial.h"
-#include <stdio.h>
 #include "rfid.h"
 #include "cat.h"
+#include "power.h"
+#include "light.h"
+#include "timer.h"
+#include "rtc.h"
+#include "mode.h"
+#include "config.h"
+#include "frame.h"
+#include "command.h"
 
 /**
- * time to keep door open
+ * Defines for button handling
  */
-#define OPEN_TIME 5000
+#define GREEN_PRESS BTN_GREEN
+#define RED_PRESS BTN_RED
+#define BOTH_PRESS (BTN_GREEN | BTN_RED)
+
+//Sequenced commands waiting to run (power of 2)
+#define CMD_QUEUE 4
+
+//Shortest telemetry period (ms)
+#define TLM_MIN_PERIOD 100
+//Every field is sent again after this many periods
+#define TLM_REFRESH 10
+//Light change sent at the period (ADC counts), smaller changes are noise
+#define TLM_LIGHT_DELTA 8
+
+//Sequenced commands, run in order from the main loop
+static struct{
+    uint8_t rIndex;
+    uint8_t wIndex;
+    struct{
+        uint8_t seq;
+        uint8_t cmd;
+        uint8_t args[CMD_ARGS];
+    }entries[CMD_QUEUE];
+    bool waiting;           //Mode change done once the latches settle
+    uint8_t waitSeq;
+}cmdQueue;
+//Commands refused (unknown, invalid parameter)
+static uint16_t cmdErrors = 0;
+//Commands whose parameters did not arrive
+static uint16_t cmdTimeouts = 0;
+//Telemetry push ('P' command), last values sent
+static struct{
+    uint16_t period;        //0 when stopped
+    uint8_t count;          //Periods since the last full report
+    uint8_t mode;
+    uint16_t status;
+    bool night;
+    uint16_t home;
+    uint16_t light;
+    uint16_t poll;
+}telemetry;
+//Number of accepted cats since boot
+static uint16_t acceptCount = 0;
+//Tag detected to latch energised latency of the last accept (us)
+static uint32_t lastLatency = 0;
+//Worst tag detected to latch energised latency (us)
+static uint32_t maxLatency = 0;
+//How long the entrance stayed unlocked on the last accept
+static ms_t lastOpenTime = 0;
 
 /**
- * Number of milliseconds
- * between light sensor read
+ * Handles button press
+ * Consumes the debounced events queued by the interrupts, so press
+ * durations do not depend on how long the main loop was busy.
+ * A gesture ends when all buttons are released.
+ * @param time Time of press
+ * @return Button status
  */
-#define LIGHT_READ_PERIOD 5000
+uint8_t handleButtons(ms_t *time){
+    static ms_t start = 0;
+    static uint8_t held = 0;
+    static uint8_t pressed = 0;
+    struct ButtonEvent ev;
+    uint8_t ret = 0;
+    while((ret == 0) && getButtonEvent(&ev)){
+        uint8_t button = ev.event & (BTN_GREEN | BTN_RED);
+        if(ev.event & BTN_RELEASE){
+            held &= ~button;
+            if((held == 0) && (pressed != 0)){
+                //All released, report every button seen in the gesture
+                ret = pressed;
+                *time = ev.time - start;
+                pressed = 0;
+            }
+        }else{
+            if(held == 0){
+                //First button of a gesture
+                start = ev.time;
+                pressed = 0;
+            }
+            held |= button;
+            pressed |= button;
+        }
+    }
+    return ret;
+}
 
+/**
+ * Build a bit pattern containing all status
+ * Bit 0 : In lock (1 means locked)
+ * Bit 1 : Out locked
+ * Bit 2 : Flap open to go in (based on pot)
+ * Bit 3 : Flap open to go out (based on pot) 
+ * @return A bit pattern 
+ */
+uint16_t buildStatusBits(){
+    uint16_t ret = 0;
+    if(isInLocked()){ ret = 0x1; }
+    if(isOutLocked()){ ret |= 0x2; }
+    return ret;
+}
+
+void printStatus(){
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_STATUS);
+        framePut(getMode());
+        framePutShort(getLight());
+        framePutShort(buildStatusBits());
+        framePutShort(getPollInterval());
+        frameEnd();
+        return;
+    }
+    // Verbose human-readable status output
+    putString("STATUS: Mode=");
+    putUint(getMode());
+    putString(" Light=");
+    putUint(getLight());
+    putString(" Pos=0 Status=0x");
+    putHex16(buildStatusBits());
+    putString(" InLocked=");
+    putch(isInLocked() ? '1' : '0');
+    putString(" OutLocked=");
+    putch(isOutLocked() ? '1' : '0');
+    putString(" Poll=");
+    putUint(getPollInterval());
+    putString("\r\n");
+}
 
+void printStats(){
+    if(!outputEnabled(OUT_STATS)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_STATS);
+        framePutShort(acceptCount);
+        framePutLong(lastLatency);
+        framePutLong(maxLatency);
+        framePutLong(lastOpenTime);
+        framePutShort(door.passages);
+        framePut(uartErrors.framingErrors);
+        framePut(uartErrors.overrunErrors);
+        framePut(uartErrors.bufferOverflows);
+        framePutShort(uartErrors.txDrops);
+        framePutShort(cmdErrors);
+        framePutShort(cmdTimeouts);
+        framePutLong(getSleepTime());
+        framePutLong(getSlowTime());
+        frameEnd();
+        return;
+    }
+    putString("STATS: Accepts=");
+    putUint(acceptCount);
+    putString(" LatencyUs=");
+    putUlong(lastLatency);
+    putString(" MaxLatencyUs=");
+    putUlong(maxLatency);
+    putString(" OpenTime=");
+    putUlong(lastOpenTime);
+    putString(" Passages=");
+    putUint(door.passages);
+    putString(" FramingErrors=");
+    putUint(uartErrors.framingErrors);
+    putString(" OverrunErrors=");
+    putUint(uartErrors.overrunErrors);
+    putString(" BufferOverflows=");
+    putUint(uartErrors.bufferOverflows);
+    putString(" TxDrops=");
+    putUint(uartErrors.txDrops);
+    putString(" CmdErrors=");
+    putUint(cmdErrors);
+    putString(" CmdTimeouts=");
+    putUint(cmdTimeouts);
+    putString(" Slept=");
+    putUlong(getSleepTime());
+    putString(" SlowClock=");
+    putUlong(getSlowTime());
+    putString("\r\n");
+}
 
 /**
- * Operating mode of flap
+ * Report which cats are known to be inside
  */
-#define MODE_NORMAL 0
-#define MODE_VET 1
-#define MODE_CLOSED 2
-#define MODE_NIGHT 3
-#define MODE_LEARN 4
-#define MODE_CLEAR 5
-#define MODE_OPEN 6
+void printOccupancy(void)
+{
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_OCCUPANCY);
+        framePutShort(getHomeCats());
+        framePutShort(getStoredCats());
+        framePut(allCatsHome() ? 1 : 0);
+        frameEnd();
+        return;
+    }
+    putString("OCCUPANCY: Home=0x");
+    putHex16(getHomeCats());
+    putString(" Stored=0x");
+    putHex16(getStoredCats());
+    putString(" AllHome=");
+    putch(allCatsHome() ? '1' : '0');
+    putString("\r\n");
+}
 
 /**
- * Defines for button handling
+ * Report the wall clock
  */
-#define GREEN_PRESS 1
-#define RED_PRESS 2
-#define BOTH_PRESS 3
-
-#define CMD_STATE_IDLE 0
-#define CMD_STATE_STAT 1
-#define CMD_STATE_MODE 2 
-#define CMD_STATE_SETTING 3
-
-//Operation mode
-static uint8_t opMode = MODE_NORMAL;    
-//Is the out locked?
-static bool outLocked = false;
-//Is the in locked
-static bool inLocked = false;
-//Light sensor value
-static uint16_t light = 0;
-//Light sensor threshold
-static uint16_t lightThd = 0;
+void printClock(void)
+{
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_CLOCK);
+        framePutLong(getTime());
+        framePut(timeValid() ? 1 : 0);
+        framePutShort((uint16_t)getDrift());
+        frameEnd();
+        return;
+    }
+    uint16_t minute = getMinuteOfDay();
+    putString("CLOCK: Time=");
+    putUlong(getTime());
+    putString(" Local=");
+    putDec2((uint8_t)(minute/60));
+    putch(':');
+    putDec2((uint8_t)(minute%60));
+    putString(" Valid=");
+    putch(timeValid() ? '1' : '0');
+    putString(" Drift=");
+    putInt(getDrift());
+    putString("\r\n");
+}
 
 /**
- * Switch flap operating mode
- * @param mode
+ * Pass a setting to the module using it
+ * @param index Configuration index
  */
-void switchMode(uint8_t mode){    
-    switch(mode){
-        case MODE_NIGHT:
-        case MODE_NORMAL:
-        case MODE_LEARN:
-        case MODE_CLEAR:
-            //Cat is allowed to go out
-            outLocked = lockRedLatch(false);
-            inLocked = lockGreenLatch(true);
+void applyConfig(uint8_t index)
+{
+    switch(index){
+        case LIGHT_CFG:
+        case LIGHT_HYST_CFG:
+        case LIGHT_DWELL_CFG:
+            setLightLimits(configValue(LIGHT_CFG), configValue(LIGHT_HYST_CFG),
+                           configValue(LIGHT_DWELL_CFG));
             break;
-        case MODE_VET:
-        case MODE_CLOSED:
-            //Cat cannot go out
-            outLocked = lockRedLatch(true);
-            inLocked = lockGreenLatch(true);
+        case LIGHT_PERIOD_CFG:
+            setLightPeriod(configValue(LIGHT_PERIOD_CFG));
             break;
-        case MODE_OPEN:
-            //Free party mode
-            outLocked = lockRedLatch(false);
-            inLocked = lockGreenLatch(false);
+        case IDLE_CFG:
+            setIdlePolicy((uint8_t)configValue(IDLE_CFG));
             break;
-        default:
-            //Cat is allowed to go out
-            outLocked = lockRedLatch(false);
-            inLocked = lockGreenLatch(true);
-            mode = MODE_NORMAL;
+        case RTC_DRIFT_CFG:
+            setDrift((int16_t)configValue(RTC_DRIFT_CFG));
+            break;
+        case POLL_MIN_CFG:
+        case POLL_MAX_CFG:
+            setPollLimits(configValue(POLL_MIN_CFG), configValue(POLL_MAX_CFG));
+            break;
+        case RFID_BIT_CFG:
+        case RFID_CARRIER_CFG:
+            setRFIDThresholds(configValue(RFID_BIT_CFG), configValue(RFID_CARRIER_CFG));
+            break;
+        case LATCH_PULSE_CFG:
+            setLatchPulse(configValue(LATCH_PULSE_CFG));
+            break;
+        case TX_POLICY_CFG:
+            setTxPolicy((uint8_t)configValue(TX_POLICY_CFG));
             break;
+        case PROTO_CFG:
+            setProtocol((uint8_t)configValue(PROTO_CFG));
+            break;
+        case FLOW_CFG:
+            setFlowControl(configValue(FLOW_CFG) != 0);
+            break;
+        case OUTPUT_CFG:
+            setOutputMask((uint8_t)configValue(OUTPUT_CFG));
+            break;
+        default:
+            //Other settings are read when used
+            ;
     }
-    opMode = mode;
 }
 
 /**
- * Handles button press
- * @param time Time of press
- * @return Button status
+ * No new cat was seen during the learn window
  */
-uint8_t handleButtons(ms_t *time){
-    static bool greenPrev = true;
-    static bool redPrev = true;
-    static ms_t start = 0;
-    static bool bothPressed = false;
-    uint8_t ret = 0;
-    bool green = GREEN_BTN;
-    bool red = RED_BTN;
-    ms_t now = millis();
-    ms_t elapsed = now-start;
-    if(!green && greenPrev){
-        //Rising edge on green
-        start = millis();
-        bothPressed = false;
-    }else if(green && !greenPrev){
-        //Falling edge on green
-        //Is the red button pressed?
-        if(bothPressed){
-            ret = BOTH_PRESS;
+void learnTimeout(void)
+{
+    if(getMode() == MODE_LEARN){
+        printLearnEvent(LEARN_TIMEOUT, 0);
+        switchMode(MODE_NORMAL);
+    }
+}
+
+/**
+ * Report learn mode progress
+ */
+void printLearn(void)
+{
+    if(!outputEnabled(OUT_CAT)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_LEARN);
+        framePut((getMode() == MODE_LEARN) ? 1 : 0);
+        framePutShort((getMode() == MODE_LEARN) ? timerRemaining(TIMER_LEARN) : 0);
+        frameEnd();
+        return;
+    }
+    if(getMode() == MODE_LEARN){
+        uint16_t remaining = timerRemaining(TIMER_LEARN);
+        putString("LEARN: Active Elapsed=");
+        putUint(LEARN_TIME-remaining);
+        putString(" Remaining=");
+        putUint(remaining);
+        putString("\r\n");
+    }else{
+        putString("LEARN: Idle\r\n");
+    }
+}
+
+/**
+ * Send the telemetry fields and remember them as sent
+ * @param fields TLM_* fields
+ */
+void printTelemetry(uint8_t fields)
+{
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    //Fields not sent keep the value the host knows
+    if(fields & TLM_MODE){ telemetry.mode = getMode(); }
+    if(fields & TLM_STATUS){ telemetry.status = buildStatusBits(); }
+    if(fields & TLM_NIGHT){ telemetry.night = isNight(); }
+    if(fields & TLM_HOME){ telemetry.home = getHomeCats(); }
+    if(fields & TLM_LIGHT){ telemetry.light = getLight(); }
+    if(fields & TLM_POLL){ telemetry.poll = getPollInterval(); }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_TELEMETRY);
+        framePut(fields);
+        if(fields & TLM_MODE){ framePut(telemetry.mode); }
+        if(fields & TLM_STATUS){ framePutShort(telemetry.status); }
+        if(fields & TLM_NIGHT){ framePut(telemetry.night ? 1 : 0); }
+        if(fields & TLM_HOME){ framePutShort(telemetry.home); }
+        if(fields & TLM_LIGHT){ framePutShort(telemetry.light); }
+        if(fields & TLM_POLL){ framePutShort(telemetry.poll); }
+        frameEnd();
+        return;
+    }
+    putString("TELEMETRY:");
+    if(fields & TLM_MODE){
+        putString(" Mode=");
+        putUint(telemetry.mode);
+    }
+    if(fields & TLM_STATUS){
+        putString(" Status=0x");
+        putHex16(telemetry.status);
+    }
+    if(fields & TLM_NIGHT){
+        putString(" Night=");
+        putch(telemetry.night ? '1' : '0');
+    }
+    if(fields & TLM_HOME){
+        putString(" Home=0x");
+        putHex16(telemetry.home);
+    }
+    if(fields & TLM_LIGHT){
+        putString(" Light=");
+        putUint(telemetry.light);
+    }
+    if(fields & TLM_POLL){
+        putString(" Poll=");
+        putUint(telemetry.poll);
+    }
+    putString("\r\n");
+}
+
+/**
+ * Start or stop pushing telemetry
+ * @param period Time between two reports (ms), 0 stops
+ */
+void startTelemetry(uint16_t period)
+{
+    telemetry.period = period;
+    if(period == 0){
+        timerStop(TIMER_STREAM);
+        if(!outputEnabled(OUT_STATUS)){
+            return;
+        }
+        if(getProtocol() == PROTO_BINARY){
+            //No field present
+            frameBegin(FRAME_TELEMETRY);
+            framePut(0);
+            frameEnd();
         }else{
-            ret = GREEN_PRESS;
+            putString("TELEMETRY: Stopped\r\n");
         }
-    }else if(!green && !greenPrev){
-        //Button pressed
-        if(!red){
-            bothPressed = true;
+        return;
+    }
+    if(period < TLM_MIN_PERIOD){
+        telemetry.period = TLM_MIN_PERIOD;
+    }
+    timerStart(TIMER_STREAM, telemetry.period, true);
+    telemetry.count = 0;
+    printTelemetry(TLM_ALL);
+}
+
+/**
+ * Push the telemetry that changed, from the main loop
+ * Events (mode, latches, night, occupancy) are sent as soon as they
+ * change, light and poll interval once per period. All fields are sent
+ * every TLM_REFRESH periods so the host knows the flap is alive.
+ */
+void serviceTelemetry(void)
+{
+    uint8_t fields = 0;
+    if((telemetry.period == 0) || !outputEnabled(OUT_STATUS)){
+        return;
+    }
+    if(getMode() != telemetry.mode){ fields |= TLM_MODE; }
+    if(buildStatusBits() != telemetry.status){ fields |= TLM_STATUS; }
+    if(isNight() != telemetry.night){ fields |= TLM_NIGHT; }
+    if(getHomeCats() != telemetry.home){ fields |= TLM_HOME; }
+    if(timerExpired(TIMER_STREAM)){
+        uint16_t light = getLight();
+        if(++telemetry.count >= TLM_REFRESH){
+            telemetry.count = 0;
+            fields = TLM_ALL;
+        }
+        if((light > telemetry.light + TLM_LIGHT_DELTA) ||
+                (light + TLM_LIGHT_DELTA < telemetry.light)){
+            fields |= TLM_LIGHT;
         }
-    }else if(!red && redPrev){
-        //Rising edge on red only
-        start = millis();
-        bothPressed = false;
-    }else if(red && !redPrev){
-        //Falling edge on red
-        //Is the red button pressed?
-        if(!green){
-            ret = BOTH_PRESS;
+        if(getPollInterval() != telemetry.poll){ fields |= TLM_POLL; }
+    }
+    if(fields != 0){
+        printTelemetry(fields);
+    }
+}
+
+/**
+ * Report the baud rate in use
+ */
+void printBaud(void)
+{
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    uint16_t divider = getBaudDivider();
+    uint32_t rate = BAUD_ACTUAL(_XTAL_FREQ, divider);
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_BAUD);
+        framePutLong(rate);
+        framePutShort(divider);
+        frameEnd();
+        return;
+    }
+    putString("BAUD: Rate=");
+    putUlong(rate);
+    putString(" Divider=");
+    putUint(divider);
+    putString("\r\n");
+}
+
+/**
+ * Report a scheduled mode change
+ * @param mode Mode entered
+ */
+void printSchedule(uint8_t mode)
+{
+    if(!outputEnabled(OUT_STATUS)){
+        return;
+    }
+    uint16_t minute = getMinuteOfDay();
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_SCHEDULE);
+        framePut(mode);
+        framePutShort(minute);
+        frameEnd();
+        return;
+    }
+    putString("SCHEDULE: Mode ");
+    putUint(mode);
+    putString(" at ");
+    putDec2((uint8_t)(minute/60));
+    putch(':');
+    putDec2((uint8_t)(minute%60));
+    putString("\r\n");
+}
+
+/**
+ * Report a failed command
+ * Details the caller adds after the text are dropped in binary mode
+ * @param code ERR_* code sent in binary mode
+ * @param text Message, or its start, sent in text mode
+ * @return false if errors are muted, the caller must not add details
+ */
+bool printError(uint8_t code, const char* text)
+{
+    if(!outputEnabled(OUT_ERROR)){
+        return false;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_ERROR);
+        framePut(code);
+        frameEnd();
+    }else{
+        putString(text);
+    }
+    return true;
+}
+
+/**
+ * Report a configuration value
+ * @param set true after a change, false after a read
+ * @param index Configuration index
+ * @param value Value
+ */
+void printConfig(bool set, uint8_t index, uint16_t value)
+{
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_CONFIG);
+        framePut(index);
+        framePutShort(value);
+        frameEnd();
+        return;
+    }
+    putString(set ? "CONFIG: Set index=" : "CONFIG: Read index=");
+    putUint(index);
+    putString(" value=");
+    putUint(value);
+    putString("\r\n");
+}
+
+/**
+ * Report a refused configuration index, or value with the setting limits
+ * @param index Configuration index
+ */
+void printConfigError(uint8_t index)
+{
+    uint16_t min = 0;
+    uint16_t max = CFG_WORDS-1;
+    ++cmdErrors;
+    if(!outputEnabled(OUT_ERROR)){
+        return;
+    }
+    if(index < CFG_WORDS){
+        configLimits(index, &min, &max);
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_ERROR);
+        framePut(ERR_RANGE);
+        framePutShort(min);
+        framePutShort(max);
+        framePut(index);
+        frameEnd();
+        return;
+    }
+    putString((index < CFG_WORDS) ? "ERROR: Value out of range index=" :
+                                    "ERROR: Index out of range index=");
+    putUint(index);
+    putString(" min=");
+    putUint(min);
+    putString(" max=");
+    putUint(max);
+    putString("\r\n");
+}
+
+/**
+ * Report several configuration values in one reply
+ * @param set true after a change, false after a read
+ * @param pairs Batch entries (index first) or NULL for a range
+ * @param first First index of the range when pairs is NULL
+ * @param count Number of values
+ */
+void printConfigs(bool set, const uint8_t* pairs, uint8_t first, uint8_t count)
+{
+    bool binary = (getProtocol() == PROTO_BINARY);
+    if(binary){
+        frameBegin(FRAME_CONFIGS);
+        framePut(count);
+    }else{
+        putString(set ? "CONFIG: Set" : "CONFIG: Read");
+    }
+    for(uint8_t i=0;i<count;++i){
+        uint8_t index = (pairs != NULL) ? pairs[i*3] : (uint8_t)(first+i);
+        uint16_t value = configValue(index);
+        if(binary){
+            framePut(index);
+            framePutShort(value);
         }else{
-            ret = RED_PRESS;
+            putch(' ');
+            putUint(index);
+            putch('=');
+            putUint(value);
         }
-    }else if(!red && !redPrev){
-        //Button pressed
-        if(!green){
-            bothPressed = true;
+    }
+    if(binary){
+        frameEnd();
+    }else{
+        putString("\r\n");
+    }
+}
+
+/**
+ * Report a sequenced command accepted or completed
+ * @param type FRAME_ACK or FRAME_DONE
+ * @param seq Sequence number given by the host
+ */
+void printSequence(uint8_t type, uint8_t seq)
+{
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(type);
+        framePut(seq);
+        frameEnd();
+        return;
+    }
+    putString((type == FRAME_ACK) ? "ACK: Seq=" : "DONE: Seq=");
+    putUint(seq);
+    putString("\r\n");
+}
+
+/**
+ * Send a received character and its code, as "'X' (0xXX)"
+ * Non printable characters are shown as '.'
+ * @param c Character
+ */
+void printChar(uint8_t c)
+{
+    putch('\'');
+    putch((c >= 32 && c < 127) ? (char)c : '.');
+    putString("' (0x");
+    putHex8(c);
+    putString(")\r\n");
+}
+
+/**
+ * Announce a command once its first byte is received
+ * @param c Command byte
+ */
+void startCommand(uint8_t c)
+{
+    const char* name = commandName(c);
+    // Echo the received character for debugging
+    if(outputEnabled(OUT_ECHO)){
+        putString("RX: ");
+        printChar(c);
+    }
+    if(name == NULL){
+        //Not handled, ignore it
+        ++cmdErrors;
+        if(printError(ERR_UNKNOWN, "WARN: Unknown command ")){
+            printChar(c);
         }
+        return;
+    }
+    if(outputEnabled(OUT_TRACE)){
+        putString("CMD: ");
+        putString(name);
+        putString("\r\n");
     }
-    *time = elapsed;
-    greenPrev = green;
-    redPrev = red;
-    return ret;
 }
 
 /**
- * Learn a new cat and save it to eeprom
+ * Report a command whose parameters stopped arriving
+ * @param cmd Command byte
+ * @param len Number of parameters received
  */
-void learnCat(void)
+void commandTimeout(uint8_t cmd, uint8_t len)
 {
-    uint16_t crcRead;    
-    ms_t t = millis();
-    ms_t now = 0;
-    uint16_t i =0;
-    Cat cat;
-    do{
-        uint8_t r = readRFID(&cat.id[0], 6, &cat.crc, &crcRead);
-        if((r ==0) && (cat.crc == crcRead) && (crcRead != 0)){        
-            uint8_t slot = saveCat(&cat);
-            if(slot>0){
-                //Saved successfully
-                beep();
-                break;
+    ++cmdTimeouts;
+    if(cmd == 'P'){
+        //No R/S selector, both bytes are the period
+        printError(ERR_TIMEOUT, "ERROR: Timeout reading period\r\n");
+    }else if(len == 0){
+        printError(ERR_TIMEOUT, (cmd == 'M') ? "ERROR: Timeout reading mode value\r\n" :
+                                               "ERROR: Timeout reading R/S parameter\r\n");
+    }else if((cmd == 'C') && (len == 1)){
+        printError(ERR_TIMEOUT, "ERROR: Timeout reading index\r\n");
+    }else{
+        printError(ERR_TIMEOUT, "ERROR: Timeout reading value\r\n");
+    }
+}
+
+/**
+ * Run a complete command
+ * @param cmd Command byte
+ * @param args Parameters, shorts are LSB first
+ */
+void runCommand(uint8_t cmd, const uint8_t* args)
+{
+    bool set = (args[0] == 'S');
+    switch(cmd){
+        case 'S':
+            //Get status
+            printStatus();
+            break;
+        case 'T':
+            //Get statistics
+            printStats();
+            break;
+        case 'L':
+            //Get learn progress
+            printLearn();
+            break;
+        case 'O':
+            //Read/override the occupancy
+            if(set){
+                setHomeCats(args[1] | ((uint16_t)args[2] << 8));
             }
+            printOccupancy();
+            break;
+        case 'K':
+            //Read/set the clock, seconds since 1970 LSB first
+            if(set){
+                setTime(args[1] | ((uint32_t)args[2] << 8) |
+                        ((uint32_t)args[3] << 16) | ((uint32_t)args[4] << 24));
+            }
+            printClock();
+            break;
+        case 'C':
+            //Change/read a configuration
+            if(set){
+                uint16_t value = args[2] | ((uint16_t)args[3] << 8);
+                if(setConfigValue(args[1], value)){
+                    printConfig(true, args[1], value);
+                    applyConfig(args[1]);
+                }else{
+                    printConfigError(args[1]);
+                }
+            }else if(args[1] >= CFG_WORDS){
+                printConfigError(args[1]);
+            }else{
+                printConfig(false, args[1], configValue(args[1]));
+            }
+            break;
+        case 'G':
+            //Read a range or change several configurations, one reply
+            if(!set){
+                uint8_t first = args[1];
+                uint8_t count = args[2];
+                if(first >= CFG_WORDS){
+                    count = 0;
+                }else if(count > (CFG_WORDS - first)){
+                    count = CFG_WORDS - first;
+                }
+                printConfigs(false, NULL, first, count);
+            }else if((args[1] == 0) || (args[1] > CFG_BATCH)){
+                ++cmdErrors;
+                if(outputEnabled(OUT_ERROR)){
+                    if(getProtocol() == PROTO_BINARY){
+                        frameBegin(FRAME_ERROR);
+                        framePut(ERR_RANGE);
+                        framePutShort(1);
+                        framePutShort(CFG_BATCH);
+                        frameEnd();
+                    }else{
+                        putString("ERROR: Batch out of range min=1 max=");
+                        putUint(CFG_BATCH);
+                        putString("\r\n");
+                    }
+                }
+            }else{
+                uint8_t failed = 0;
+                if(setConfigValues(cmdBatch, args[1], &failed)){
+                    for(uint8_t i=0;i<args[1];++i){
+                        applyConfig(cmdBatch[i*3]);
+                    }
+                    printConfigs(true, cmdBatch, 0, args[1]);
+                }else{
+                    //Nothing was written, report the first refused entry
+                    printConfigError(cmdBatch[failed*3]);
+                }
+            }
+            break;
+        case 'B':
+            //Measure the host rate from the next 0x55 character
+            if(outputEnabled(OUT_STATUS)){
+                if(getProtocol() == PROTO_BINARY){
+                    //Rate 0: measuring, the divider is restored on failure
+                    frameBegin(FRAME_BAUD);
+                    framePutLong(0);
+                    framePutShort(getBaudDivider());
+                    frameEnd();
+                }else{
+                    putString("BAUD: Send 0x55 at the new rate\r\n");
+                }
+            }
+            startAutoBaud();
+            break;
+        case 'P':
+            //Push telemetry every period ms, 0 stops
+            startTelemetry(args[0] | ((uint16_t)args[1] << 8));
+            break;
+        case 'M':
+            //Change mode
+            if(args[0]<MODE_COUNT){
+                switchMode(args[0]);
+                if(getProtocol() == PROTO_BINARY){
+                    frameBegin(FRAME_MODE);
+                    framePut(getMode());
+                    frameEnd();
+                }else{
+                    putString("MODE: Changed to ");
+                    putUint(getMode());
+                    putString("\r\n");
+                }
+            }else{
+                ++cmdErrors;
+                if(printError(ERR_MODE, "ERROR: Invalid mode ")){
+                    putUint(args[0]);
+                    putString(" (max=");
+                    putUint(MODE_COUNT-1);
+                    putString(")\r\n");
+                }
+            }
+            break;
+        default:
+            ;
+    }
+}
+
+/**
+ * Queue the parsed sequenced command and acknowledge it
+ */
+void queueCommand(void)
+{
+    uint8_t queued = (uint8_t)(cmdQueue.wIndex - cmdQueue.rIndex);
+    if((cmdParser.cmd == 'G') && (cmdParser.args[0] == 'S')){
+        //Batch entries are not queued, the next batch would overwrite them
+        if(queued == 0){
+            printSequence(FRAME_ACK, cmdParser.seq);
+            runCommand(cmdParser.cmd, cmdParser.args);
+            printSequence(FRAME_DONE, cmdParser.seq);
+            return;
         }
-        ++i;
-        if(i>9){
-            i = 0;
-            GREEN_LED = !GREEN_LED;
+        //Running it now would overtake the queued commands
+        ++cmdErrors;
+        if(printError(ERR_BATCH_BUSY, "ERROR: Batch busy Seq=")){
+            putUint(cmdParser.seq);
+            putString("\r\n");
+        }
+        return;
+    }
+    if(queued >= CMD_QUEUE){
+        ++cmdErrors;
+        if(printError(ERR_BUSY, "ERROR: Queue full Seq=")){
+            putUint(cmdParser.seq);
+            putString("\r\n");
         }
-        __delay_ms(20);
-        now = millis();
-    }while((now-t)<30000);
-    GREEN_LED = 0;
+        return;
+    }
+    uint8_t i = cmdQueue.wIndex & (CMD_QUEUE - 1);
+    cmdQueue.entries[i].seq = cmdParser.seq;
+    cmdQueue.entries[i].cmd = cmdParser.cmd;
+    for(uint8_t j=0;j<CMD_ARGS;++j){
+        cmdQueue.entries[i].args[j] = cmdParser.args[j];
+    }
+    ++cmdQueue.wIndex;
+    printSequence(FRAME_ACK, cmdParser.seq);
 }
 
 /**
- * Build a bit pattern containing all status
- * Bit 0 : In lock (1 means locked)
- * Bit 1 : Out locked
- * Bit 2 : Flap open to go in (based on pot)
- * Bit 3 : Flap open to go out (based on pot) 
- * @return A bit pattern 
+ * Run the queued commands and report their completion
+ * A mode change completes once its latch pulses are done, the
+ * commands queued after it run meanwhile unless they change mode too.
  */
-uint16_t buildStatusBits(){
-    uint16_t ret = 0;
-    if(inLocked){ ret = 0x1; }
-    if(outLocked){ ret |= 0x2; }
-    return ret;
+void serviceCommands(void)
+{
+    if(cmdQueue.waiting && !latchesBusy()){
+        cmdQueue.waiting = false;
+        printSequence(FRAME_DONE, cmdQueue.waitSeq);
+    }
+    while(cmdQueue.rIndex != cmdQueue.wIndex){
+        uint8_t i = cmdQueue.rIndex & (CMD_QUEUE - 1);
+        uint8_t cmd = cmdQueue.entries[i].cmd;
+        if((cmd == 'M') && cmdQueue.waiting){
+            //One mode change in flight at a time
+            return;
+        }
+        runCommand(cmd, cmdQueue.entries[i].args);
+        ++cmdQueue.rIndex;
+        if((cmd == 'M') && latchesBusy()){
+            cmdQueue.waiting = true;
+            cmdQueue.waitSeq = cmdQueue.entries[i].seq;
+        }else{
+            printSequence(FRAME_DONE, cmdQueue.entries[i].seq);
+        }
+    }
 }
 
-void printStatus(){
-    // Verbose human-readable status output
-    printf("STATUS: Mode=%u Light=%u Pos=%u Status=0x%04X InLocked=%u OutLocked=%u\r\n", 
-           (unsigned int)opMode, (unsigned int)light, (unsigned int)0, (unsigned int)buildStatusBits(), 
-           inLocked ? 1U : 0U, outLocked ? 1U : 0U);
+/**
+ * Feed a received byte to the command parser and run the command it
+ * completes, sequenced commands are queued
+ * @param b Byte
+ */
+void handleByte(uint8_t b)
+{
+    uint8_t parsed = parseByte(b);
+    if(parsed & PARSE_COMMAND){
+        startCommand(b);
+    }
+    if(!(parsed & PARSE_READY)){
+        return;
+    }
+    if(cmdParser.tagged){
+        queueCommand();
+    }else{
+        runCommand(cmdParser.cmd, cmdParser.args);
+    }
 }
 
 /**
  * Handle all serial communication with external
+ * Consumes the bytes already received and never waits for more. A
+ * command split over several passes is kept until its parameters
+ * arrive or SERIAL_TIMEOUT_CFG elapses between two bytes.
+ * Commands prefixed with '#' and a sequence number are queued and
+ * acknowledged, serviceCommands() runs them.
  */
 void handleSerial(){
-    uint8_t b = 0;    
-    //Do we received a command?
-    if(byteAvail()){
-        uint8_t c = 0;
-        if(getByte(&c) == 0){
-            // Echo the received character for debugging
-            printf("RX: '%c' (0x%02X)\r\n", (c >= 32 && c < 127) ? c : '.', c);
-            
-            switch(c){
-                case 'S':
-                    //Get status
-                    printf("CMD: Status request\r\n");
-                    printStatus();
-                    break;
-                case 'C':
-                    //Change/read a configuration
-                    printf("CMD: Configuration\r\n");
-                    //read/write?
-                    if(getByte(&b) == 0){                
-                        uint8_t index = 0;
-                        //Get parameter index
-                        if(getByte(&index) == 0){
-                            if(b == 'S'){
-                                //Set the configuration                    
-                                uint16_t value = 0;
-                                if(getShort(&value) == 0){
-                                    setConfiguration(index, value);
-                                    printf("CONFIG: Set index=%u value=%u\r\n", index, value);
-                                    switch(index){
-                                        case LIGHT_CFG:
-                                            lightThd = value;
-                                            break;
-                                        default:
-                                            ;
-                                    }
-                                }else{
-                                    printf("ERROR: Timeout reading value\r\n");
-                                }
-                            }else{
-                                //Read the configuration
-                                uint16_t configValue = getConfiguration(index);
-                                printf("CONFIG: Read index=%u value=%u\r\n", index, configValue);
-                            }
-                        }else{
-                            printf("ERROR: Timeout reading index\r\n");
-                        }
-                    }else{
-                        printf("ERROR: Timeout reading R/S parameter\r\n");
-                    }
-                    break;
-                case 'M':
-                    //Change mode
-                    printf("CMD: Mode change\r\n");
-                    if(getByte(&b) == 0){
-                        if(b<=MODE_OPEN){
-                            switchMode(b);
-                            printf("MODE: Changed to %u\r\n", opMode);
-                        }else{
-                            printf("ERROR: Invalid mode %u (max=%u)\r\n", (unsigned int)b, (unsigned int)MODE_OPEN);
-                        }
-                    }else{
-                        printf("ERROR: Timeout reading mode value\r\n");
-                    }
-                    break;
-                default:
-                    //Not handled, ignore it
-                    printf("WARN: Unknown command '%c' (0x%02X)\r\n", 
-                           (c >= 32 && c < 127) ? c : '.', c);
-                    return;
-            }
+    const uint8_t* data;
+    uint8_t n;
+    if((cmdParser.state != CMD_STATE_IDLE) && !timerRunning(TIMER_SERIAL)){
+        if(cmdParser.state == CMD_STATE_ARGS){
+            commandTimeout(cmdParser.cmd, cmdParser.len);
         }else{
-            printf("ERROR: Failed to read command byte\r\n");
+            ++cmdTimeouts;
+            printError(ERR_TIMEOUT, "ERROR: Timeout reading command\r\n");
         }
+        cmdParser.state = CMD_STATE_IDLE;
+    }
+    //Parse straight from the receive ring, at most twice when it wrapped
+    while(!autoBaudPending() && ((n = rxSpan(&data)) > 0)){
+        uint8_t i = 0;
+        //Stop after 'B', the bytes behind it wait for the new rate
+        while((i < n) && !autoBaudPending()){
+            handleByte(data[i++]);
+        }
+        rxConsume(i);
     }
 }
 
@@ -288,9 +976,87 @@ void handleSerial(){
  */
 void printCat(const Cat* c)
 {
+    if(!outputEnabled(OUT_CAT)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_CAT);
+        for(uint8_t i=0;i<6;++i){
+            framePut(c->id[i]);
+        }
+        framePutShort(c->crc);
+        framePutLong(getTime());
+        frameEnd();
+        return;
+    }
     // Verbose human-readable cat detection output
-    printf("CAT_DETECTED: ID=%02X%02X%02X%02X%02X%02X CRC=0x%04X\r\n",
-           c->id[0], c->id[1], c->id[2], c->id[3], c->id[4], c->id[5], c->crc);
+    putString("CAT_DETECTED: ID=");
+    for(uint8_t i=0;i<6;++i){
+        putHex8(c->id[i]);
+    }
+    putString(" CRC=0x");
+    putHex16(c->crc);
+    putString(" Time=");
+    putUlong(getTime());
+    putString("\r\n");
+}
+
+/**
+ * Store a new cat seen while in learn mode and leave learn mode
+ * @param c Cat read with a valid CRC
+ */
+void learnCat(Cat* c)
+{
+    uint8_t slot = saveCat(c);
+    if(slot>0){
+        //Saved successfully
+        beep();
+        printLearnEvent(LEARN_STORED, slot);
+    }else{
+        printLearnEvent(LEARN_FULL, 0);
+    }
+    switchMode(MODE_NORMAL);
+}
+
+/**
+ * Let a known cat in
+ * The unlock pulse is started first so the beep and the serial report
+ * happen while the solenoid is moving instead of before it.
+ * @param c Cat that was detected
+ * @param slot Slot of the cat, marked inside if the flap is passed
+ * @param detected Time at which the tag was validated (micros())
+ */
+void acceptCat(const Cat* c, uint8_t slot, uint32_t detected)
+{
+    uint8_t passages = door.passages;
+    driveGreenLatch(false);
+    lastLatency = micros() - detected;
+    ms_t unlocked = millis();
+    //Open window starts when the latch is energised
+    timerStart(TIMER_OPEN, configValue(OPEN_TIME_CFG), false);
+    setInLocked(false);
+    if(lastLatency > maxLatency){
+        maxLatency = lastLatency;
+    }
+    ++acceptCount;
+    beep();
+    printCat(c);
+    //Finish the unlock pulse
+    while((millis()-unlocked) < getLatchPulse()){}
+    releaseLatches();
+    //Relock shortly after the flap was passed, the open time is the fallback
+    while(timerRunning(TIMER_OPEN)){
+        if((door.passages != passages) && !door.open &&
+                ((millis()-doorClosedAt()) >= configValue(RELOCK_DELAY_CFG))){
+            break;
+        }
+    }
+    timerStop(TIMER_OPEN);
+    lastOpenTime = millis()-unlocked;
+    setInLocked(lockGreenLatch(true));
+    if(door.passages != passages){
+        catEntered(slot);
+    }
 }
 
 /******************************************************************************/
@@ -304,105 +1070,95 @@ void main(void)
     ms_t btnPress = 0;    
     /* Initialize I/O and Peripherals for application */
     InitApp();
-    lightThd = getConfiguration(LIGHT_CFG);    
-    // Initialize EEPROM if unprogrammed or invalid (0xFFFF=unprogrammed, >1023=out of range)
-    if(lightThd > 1023){
-        lightThd = 512;
-        setConfiguration(LIGHT_CFG, lightThd);
+    //Unprogrammed or invalid settings are replaced by their defaults
+    initConfig();
+    for(uint8_t i=0;i<CFG_WORDS;++i){
+        applyConfig(i);
     }
+    //Only once the protocol is applied, a binary host gets no text
+    printBanner();
+    initLight();
+    initOccupancy();
+    timerSetCallback(TIMER_LEARN, learnTimeout);
+    initRTC();
     switchMode(MODE_NORMAL);
-    ms_t lastLightRead = millis();
+    uint8_t passages = door.passages;
     while(1)
     {   
+        //All work below assumes the crystal clock (__delay_*, RFID)
+        clockFast();
         ms_t ms = millis();
-        if((ms-lastLightRead)>LIGHT_READ_PERIOD){
-            light = getLightSensor();           
-            lastLightRead = ms;
+        updateLight();
+        //Scheduled mode changes, checked once per minute and after K
+        if(updateRTC() && timeValid()){
+            uint8_t mode = scheduledMode();
+            //Clearing cats or learning is never scheduled
+            if((mode < MODE_COUNT) && (mode != MODE_CLEAR) &&
+                    (mode != MODE_LEARN) && (mode != getMode())){
+                printSchedule(mode);
+                switchMode(mode);
+            }
         }
-        bool doOpen = false;
-        switch(opMode){
-            case MODE_NORMAL:             
-                doOpen = true;
-                RED_LED = 0;
-                GREEN_LED = 0;
-                break;
-            case MODE_VET:
-                GREEN_LED = 0;
-                //Blink red led
-                RED_LED = ((ms>>9) & 0x1);
-                doOpen = true;
-                break;
-            case MODE_CLOSED:
-                doOpen = false;
-                //Blink both leds
-                RED_LED = ((ms>>9) & 0x1);;
-                GREEN_LED = ((ms>>9) & 0x1);
-                break;
-            case MODE_LEARN:
-                learnCat();
-                switchMode(MODE_NORMAL);
-                break;
-            case MODE_CLEAR:
-                clearCats();
-                switchMode(MODE_NORMAL);
-                break;
-            case MODE_OPEN:
-                RED_LED = 1;
-                GREEN_LED = 1;
-                doOpen = false;
-                break;
-            case MODE_NIGHT:
-                //Tests if light is not enough
-                //More is darker
-                if((light>lightThd) && !outLocked){
-                    outLocked = lockRedLatch(true);
-                    lockGreenLatch(true);
-                }else if((light<(lightThd-5)) && outLocked){
-                    outLocked = lockRedLatch(false);
-                    lockGreenLatch(true);
-                }
-                GREEN_LED = outLocked;
-                RED_LED = 1;
-                doOpen = true;
-                break;
-            default:
-                switchMode(MODE_NORMAL);
-                doOpen = false;
-                break;
+        if(door.passages != passages){
+            //Passed without an accept, an unknown cat went out
+            //Ignored when the exit is locked, nobody could pass
+            if(!isOutLocked()){
+                catLeft();
+            }
+            passages = door.passages;
+            pollActivity();
         }
-        //If open is allowed
-        if(doOpen){
+        //Someone at the flap, poll at the fastest rate
+        if(door.open || buttons.held){
+            pollActivity();
+        }
+        //Poll slowly while nobody is expected outside
+        setPollQuiet(allCatsHome());
+        uint8_t flags = runMode(ms);
+        bool doOpen = (flags & MODE_RFID) != 0;
+        if(flags & MODE_FAST_POLL){
+            pollActivity();
+        }
+        //Mode changes pulse the latches in the background
+        //The red latch shares the L293D channel with the RFID exciter
+        bool latchMoving = serviceLatches();
+        //If open is allowed and the poll is due
+        if(doOpen && !latchMoving && pollDue()){
             //Read RFID chip
             r = readRFID(&c.id[0], 6, &c.crc, &crcRead);
-            if(r == 0 && catExists(&c, &crcRead)){
+            uint32_t detected = micros();
+            uint8_t slot = (r == 0) ? findCat(&c, &crcRead) : 0;
+            if(slot > 0){
                 //Read ok and found in EEPROM
-                beep();
-                inLocked = lockGreenLatch(false);
-                printCat(&c);
-                __delay_ms(OPEN_TIME);
-                inLocked = lockGreenLatch(true);                
+                acceptCat(&c, slot, detected);
+                //Passages during the accept are entries
+                passages = door.passages;
+            }else if((r == 0) && (crcRead != 0) && (getMode() == MODE_LEARN)){
+                //Valid unknown tag while learning
+                learnCat(&c);
             }
             c.crc = 0x0;
-            //Relax
-            __delay_ms(20);
         }
         
         //Handle buttons modes
         switch(handleButtons(&btnPress)){
             case GREEN_PRESS :
-                if(btnPress>10000){
+                if(getMode() == MODE_LEARN){
+                    printLearnEvent(LEARN_CANCELLED, 0);
+                    switchMode(MODE_NORMAL);
+                }else if(btnPress>configValue(LEARN_HOLD_CFG)){
                     switchMode(MODE_LEARN);
                 }
                 break;
             case RED_PRESS :
-                if(btnPress>5000){
-                    if(opMode == MODE_VET){
+                if(btnPress>configValue(VET_HOLD_CFG)){
+                    if(getMode() == MODE_VET){
                         switchMode(MODE_NORMAL);
                     }else{
                         switchMode(MODE_VET);
                     }
-                }else if(btnPress<2000){
-                    if(opMode == MODE_NIGHT){
+                }else if(btnPress<configValue(NIGHT_PRESS_CFG)){
+                    if(getMode() == MODE_NIGHT){
                         switchMode(MODE_NORMAL);
                     }else{
                         switchMode(MODE_NIGHT);                        
@@ -412,14 +1168,33 @@ void main(void)
             case BOTH_PRESS :
                 /*if((btnPress>2000) && (btnPress<30000)){
                     //TODO: Extended mode, to be implemented
-                }else*/ if(btnPress>30000){
+                }else*/ if(btnPress>configValue(CLEAR_HOLD_CFG)){
                     switchMode(MODE_CLEAR);                    
                 }
                 break;              
         }
         
         //Handle serial comm
-        handleSerial();
+        switch(serviceAutoBaud()){
+            case BAUD_DONE:
+                printBaud();
+                break;
+            case BAUD_FAILED:
+                printError(ERR_TIMEOUT, "ERROR: Auto-baud failed\r\n");
+                break;
+            case BAUD_PENDING:
+                //Receive is stopped until the rate is known
+                break;
+            default:
+                handleSerial();
+        }
+        serviceCommands();
+        serviceTelemetry();
+        serviceTimers();
+        saveOccupancy();
+        
+        //Relax until the next RFID poll, sleeping if nothing is pending
+        relax((doOpen && (pollWait() < IDLE_WDT_MS(IDLE_LONG))) ? IDLE_POLL : IDLE_LONG);
     }
 }
 
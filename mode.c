@@ -0,0 +1,177 @@
+/*
+ * File:   mode.c
+ * Comments: Operating modes of the flap, described by a constant table
+ */
+
+#include <xc.h>
+#include <stddef.h>
+#include "mode.h"
+#include "peripherials.h"
+#include "light.h"
+#include "timer.h"
+#include "cat.h"
+#include "serial.h"
+#include "frame.h"
+
+static void learnEnter(void);
+static void learnExit(void);
+
+//Indexed by MODE_*
+//locks, green LED, red LED, flags, next, enter, exit
+static const ModeDescriptor modes[MODE_COUNT] = {
+    //MODE_NORMAL: cat is allowed to go out
+    {LOCK_IN, LED_OFF, LED_OFF, MODE_RFID, MODE_NORMAL, NULL, NULL},
+    //MODE_VET: cat cannot go out
+    {LOCK_IN | LOCK_OUT, LED_OFF, LED_BLINK, MODE_RFID, MODE_VET, NULL, NULL},
+    //MODE_CLOSED
+    {LOCK_IN | LOCK_OUT, LED_BLINK, LED_BLINK, 0, MODE_CLOSED, NULL, NULL},
+    //MODE_NIGHT: exit locked while it is dark
+    {LOCK_IN, LED_OUT_LOCKED, LED_ON, MODE_RFID | MODE_LIGHT, MODE_NIGHT, NULL, NULL},
+    //MODE_LEARN: runs in the background, known cats are still let in
+    {LOCK_IN, LED_BLINK_FAST, LED_OFF, MODE_RFID | MODE_FAST_POLL, MODE_LEARN, learnEnter, learnExit},
+    //MODE_CLEAR: forget all cats and go back to normal
+    {LOCK_IN, LED_OFF, LED_OFF, MODE_TRANSIENT, MODE_NORMAL, clearCats, NULL},
+    //MODE_OPEN: free party mode
+    {0, LED_ON, LED_ON, 0, MODE_OPEN, NULL, NULL},
+};
+
+//Operation mode
+static uint8_t opMode = MODE_NORMAL;
+//Is the out locked?
+static bool outLocked = false;
+//Is the in locked
+static bool inLocked = false;
+
+static void learnEnter(void)
+{
+    timerStart(TIMER_LEARN, LEARN_TIME, false);
+    printLearnEvent(LEARN_STARTED, 0);
+}
+
+static void learnExit(void)
+{
+    timerStop(TIMER_LEARN);
+}
+
+/**
+ * Get the LED state for a pattern
+ * @param pattern LED_*
+ * @param ms Current time
+ * @return true if the LED is on
+ */
+static bool ledState(uint8_t pattern, ms_t ms)
+{
+    switch(pattern){
+        case LED_ON:
+            return true;
+        case LED_BLINK:
+            return ((ms>>9) & 0x1) != 0;
+        case LED_BLINK_FAST:
+            return ((ms>>8) & 0x1) != 0;
+        case LED_OUT_LOCKED:
+            return outLocked;
+        default:
+            return false;
+    }
+}
+
+void switchMode(uint8_t mode)
+{
+    if(mode >= MODE_COUNT){
+        mode = MODE_NORMAL;
+    }
+    if(modes[opMode].exit != NULL){
+        modes[opMode].exit();
+    }
+    //Transient modes chain to their next mode
+    while(1){
+        const ModeDescriptor* d = &modes[mode];
+        //Latches move from the main loop, the state is the one asked for
+        outLocked = (d->locks & LOCK_OUT) != 0;
+        inLocked = (d->locks & LOCK_IN) != 0;
+        moveLatches(LATCH_RED | LATCH_GREEN,
+                (uint8_t)((outLocked ? LATCH_RED : 0) | (inLocked ? LATCH_GREEN : 0)));
+        opMode = mode;
+        if(d->enter != NULL){
+            d->enter();
+        }
+        if(!(d->flags & MODE_TRANSIENT)){
+            break;
+        }
+        mode = d->next;
+    }
+}
+
+uint8_t runMode(ms_t ms)
+{
+    const ModeDescriptor* d = &modes[opMode];
+    if(d->flags & MODE_LIGHT){
+        //Filtered light with hysteresis and dwell
+        if(isNight() != outLocked){
+            outLocked = isNight();
+            inLocked = true;
+            moveLatches(LATCH_RED | LATCH_GREEN,
+                    (uint8_t)((outLocked ? LATCH_RED : 0) | LATCH_GREEN));
+        }
+    }
+    GREEN_LED = ledState(d->greenLed, ms);
+    RED_LED = ledState(d->redLed, ms);
+    return d->flags;
+}
+
+uint8_t getMode(void)
+{
+    return opMode;
+}
+
+bool isInLocked(void)
+{
+    return inLocked;
+}
+
+bool isOutLocked(void)
+{
+    return outLocked;
+}
+
+void setInLocked(bool locked)
+{
+    inLocked = locked;
+}
+
+void printLearnEvent(uint8_t event, uint8_t slot)
+{
+    if(!outputEnabled(OUT_CAT)){
+        return;
+    }
+    if(getProtocol() == PROTO_BINARY){
+        frameBegin(FRAME_LEARN_EVENT);
+        framePut(event);
+        framePut(slot);
+        frameEnd();
+        return;
+    }
+    switch(event){
+        case LEARN_STARTED:
+            putString("LEARN: Started timeout=");
+            putUint(LEARN_TIME/1000);
+            putString(" s\r\n");
+            break;
+        case LEARN_STORED:
+            putString("LEARN: Stored slot=");
+            putUint(slot);
+            putString("\r\n");
+            break;
+        case LEARN_FULL:
+            putString("LEARN: No free slot\r\n");
+            break;
+        case LEARN_TIMEOUT:
+            putString("LEARN: Timeout\r\n");
+            break;
+        case LEARN_CANCELLED:
+            putString("LEARN: Cancelled\r\n");
+            break;
+        default:
+            ;
+    }
+}
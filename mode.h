@@ -0,0 +1,119 @@
+/* 
+ * File:   mode.h
+ * Comments: Operating modes of the flap, described by a constant table
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef MODE_INCLUDED_H
+#define	MODE_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+#include "interrupts.h"
+
+/**
+ * Operating mode of flap
+ */
+#define MODE_NORMAL 0
+#define MODE_VET 1
+#define MODE_CLOSED 2
+#define MODE_NIGHT 3
+#define MODE_LEARN 4
+#define MODE_CLEAR 5
+#define MODE_OPEN 6
+#define MODE_COUNT 7
+
+/**
+ * Maximum time to wait for a new
+ * cat in learn mode
+ */
+#define LEARN_TIME 30000
+
+// Learn events, reported with printLearnEvent()
+#define LEARN_STARTED 1     // Waiting for a new cat
+#define LEARN_STORED 2      // New cat stored in slot
+#define LEARN_FULL 3        // No free slot for the new cat
+#define LEARN_TIMEOUT 4     // No new cat seen in LEARN_TIME
+#define LEARN_CANCELLED 5   // Left with the green button
+
+// Latches locked by a mode
+#define LOCK_IN 0x1
+#define LOCK_OUT 0x2
+
+// LED patterns
+#define LED_OFF 0
+#define LED_ON 1
+#define LED_BLINK 2         // ~1s period
+#define LED_BLINK_FAST 3    // ~0.5s period
+#define LED_OUT_LOCKED 4    // On while the exit is locked
+
+// Mode flags
+#define MODE_RFID 0x1       // Poll tags and let known cats in
+#define MODE_LIGHT 0x2      // Lock the exit at night
+#define MODE_FAST_POLL 0x4  // Keep polling at the fastest rate
+#define MODE_TRANSIENT 0x8  // Run the entry hook, then switch to next
+
+typedef void (*modeHook)(void);
+
+// Description of a mode
+typedef struct{
+    uint8_t locks;      //LOCK_IN and/or LOCK_OUT on entry
+    uint8_t greenLed;   //LED_* pattern
+    uint8_t redLed;     //LED_* pattern
+    uint8_t flags;      //MODE_* flags
+    uint8_t next;       //Mode entered after a transient one
+    modeHook enter;     //Called once the latch moves are queued, before they pulse, may be NULL
+    modeHook exit;      //Called when leaving, may be NULL
+}ModeDescriptor;
+
+/**
+ * Switch flap operating mode
+ * Unknown modes select MODE_NORMAL. Hooks must not switch mode.
+ * Returns before the latches moved, serviceLatches() pulses them.
+ * @param mode
+ */
+void switchMode(uint8_t mode);
+
+/**
+ * Apply the current mode for one main loop pass
+ * Drives the LEDs and the light policy
+ * @param ms Current time
+ * @return MODE_* flags of the current mode
+ */
+uint8_t runMode(ms_t ms);
+
+/**
+ * Get the operating mode
+ * @return MODE_*
+ */
+uint8_t getMode(void);
+
+/**
+ * Is the entrance locked?
+ * @return true if locked
+ */
+bool isInLocked(void);
+
+/**
+ * Is the exit locked?
+ * @return true if locked
+ */
+bool isOutLocked(void);
+
+/**
+ * Record an entrance latch move made outside of the mode engine
+ * @param locked New state
+ */
+void setInLocked(bool locked);
+
+/**
+ * Report a learn event, muted with OUT_CAT
+ * @param event LEARN_* event
+ * @param slot Slot used by LEARN_STORED, 0 otherwise
+ */
+void printLearnEvent(uint8_t event, uint8_t slot);
+
+#endif	/* MODE_INCLUDED_H */
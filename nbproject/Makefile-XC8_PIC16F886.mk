@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c
+SOURCEFILES_QUOTED_IF_SPACED=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c power.c light.c adc.c timer.c rtc.c mode.c config.c frame.c command.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1
-POSSIBLE_DEPFILES=${OBJECTDIR}/configuration_bits.p1.d ${OBJECTDIR}/interrupts.p1.d ${OBJECTDIR}/main.p1.d ${OBJECTDIR}/user.p1.d ${OBJECTDIR}/serial.p1.d ${OBJECTDIR}/rfid.p1.d ${OBJECTDIR}/peripherials.p1.d ${OBJECTDIR}/cat.p1.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1 ${OBJECTDIR}/power.p1 ${OBJECTDIR}/light.p1 ${OBJECTDIR}/adc.p1 ${OBJECTDIR}/timer.p1 ${OBJECTDIR}/rtc.p1 ${OBJECTDIR}/mode.p1 ${OBJECTDIR}/config.p1 ${OBJECTDIR}/frame.p1 ${OBJECTDIR}/command.p1
+POSSIBLE_DEPFILES=${OBJECTDIR}/configuration_bits.p1.d ${OBJECTDIR}/interrupts.p1.d ${OBJECTDIR}/main.p1.d ${OBJECTDIR}/user.p1.d ${OBJECTDIR}/serial.p1.d ${OBJECTDIR}/rfid.p1.d ${OBJECTDIR}/peripherials.p1.d ${OBJECTDIR}/cat.p1.d ${OBJECTDIR}/power.p1.d ${OBJECTDIR}/light.p1.d ${OBJECTDIR}/adc.p1.d ${OBJECTDIR}/timer.p1.d ${OBJECTDIR}/rtc.p1.d ${OBJECTDIR}/mode.p1.d ${OBJECTDIR}/config.p1.d ${OBJECTDIR}/frame.p1.d ${OBJECTDIR}/command.p1.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1
+OBJECTFILES=${OBJECTDIR}/configuration_bits.p1 ${OBJECTDIR}/interrupts.p1 ${OBJECTDIR}/main.p1 ${OBJECTDIR}/user.p1 ${OBJECTDIR}/serial.p1 ${OBJECTDIR}/rfid.p1 ${OBJECTDIR}/peripherials.p1 ${OBJECTDIR}/cat.p1 ${OBJECTDIR}/power.p1 ${OBJECTDIR}/light.p1 ${OBJECTDIR}/adc.p1 ${OBJECTDIR}/timer.p1 ${OBJECTDIR}/rtc.p1 ${OBJECTDIR}/mode.p1 ${OBJECTDIR}/config.p1 ${OBJECTDIR}/frame.p1 ${OBJECTDIR}/command.p1
 
 # Source Files
-SOURCEFILES=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c
+SOURCEFILES=configuration_bits.c interrupts.c main.c user.c serial.c rfid.c peripherials.c cat.c power.c light.c adc.c timer.c rtc.c mode.c config.c frame.c command.c
 
 
 CFLAGS=
@@ -157,6 +157,78 @@ ${OBJECTDIR}/cat.p1: cat.c  nbproject/Makefile-${CND_CONF}.mk
 	@-${MV} ${OBJECTDIR}/cat.d ${OBJECTDIR}/cat.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/cat.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/power.p1: power.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.p1.d 
+	@${RM} ${OBJECTDIR}/power.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/power.p1 power.c 
+	@-${MV} ${OBJECTDIR}/power.d ${OBJECTDIR}/power.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/power.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/light.p1: light.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/light.p1.d 
+	@${RM} ${OBJECTDIR}/light.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/light.p1 light.c 
+	@-${MV} ${OBJECTDIR}/light.d ${OBJECTDIR}/light.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/light.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/adc.p1: adc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/adc.p1.d 
+	@${RM} ${OBJECTDIR}/adc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/adc.p1 adc.c 
+	@-${MV} ${OBJECTDIR}/adc.d ${OBJECTDIR}/adc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/adc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/timer.p1: timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/timer.p1.d 
+	@${RM} ${OBJECTDIR}/timer.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/timer.p1 timer.c 
+	@-${MV} ${OBJECTDIR}/timer.d ${OBJECTDIR}/timer.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/timer.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/rtc.p1: rtc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/rtc.p1.d 
+	@${RM} ${OBJECTDIR}/rtc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/rtc.p1 rtc.c 
+	@-${MV} ${OBJECTDIR}/rtc.d ${OBJECTDIR}/rtc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/rtc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/mode.p1: mode.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mode.p1.d 
+	@${RM} ${OBJECTDIR}/mode.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/mode.p1 mode.c 
+	@-${MV} ${OBJECTDIR}/mode.d ${OBJECTDIR}/mode.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/mode.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/config.p1: config.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.p1.d 
+	@${RM} ${OBJECTDIR}/config.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/config.p1 config.c 
+	@-${MV} ${OBJECTDIR}/config.d ${OBJECTDIR}/config.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/config.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/frame.p1: frame.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/frame.p1.d 
+	@${RM} ${OBJECTDIR}/frame.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/frame.p1 frame.c 
+	@-${MV} ${OBJECTDIR}/frame.d ${OBJECTDIR}/frame.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/frame.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/command.p1: command.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/command.p1.d 
+	@${RM} ${OBJECTDIR}/command.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/command.p1 command.c 
+	@-${MV} ${OBJECTDIR}/command.d ${OBJECTDIR}/command.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/command.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 else
 ${OBJECTDIR}/configuration_bits.p1: configuration_bits.c  nbproject/Makefile-${CND_CONF}.mk
 	@${MKDIR} "${OBJECTDIR}" 
@@ -222,6 +294,78 @@ ${OBJECTDIR}/cat.p1: cat.c  nbproject/Makefile-${CND_CONF}.mk
 	@-${MV} ${OBJECTDIR}/cat.d ${OBJECTDIR}/cat.p1.d 
 	@${FIXDEPS} ${OBJECTDIR}/cat.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
 	
+${OBJECTDIR}/power.p1: power.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.p1.d 
+	@${RM} ${OBJECTDIR}/power.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/power.p1 power.c 
+	@-${MV} ${OBJECTDIR}/power.d ${OBJECTDIR}/power.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/power.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/light.p1: light.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/light.p1.d 
+	@${RM} ${OBJECTDIR}/light.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/light.p1 light.c 
+	@-${MV} ${OBJECTDIR}/light.d ${OBJECTDIR}/light.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/light.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/adc.p1: adc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/adc.p1.d 
+	@${RM} ${OBJECTDIR}/adc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/adc.p1 adc.c 
+	@-${MV} ${OBJECTDIR}/adc.d ${OBJECTDIR}/adc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/adc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/timer.p1: timer.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/timer.p1.d 
+	@${RM} ${OBJECTDIR}/timer.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/timer.p1 timer.c 
+	@-${MV} ${OBJECTDIR}/timer.d ${OBJECTDIR}/timer.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/timer.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/rtc.p1: rtc.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/rtc.p1.d 
+	@${RM} ${OBJECTDIR}/rtc.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/rtc.p1 rtc.c 
+	@-${MV} ${OBJECTDIR}/rtc.d ${OBJECTDIR}/rtc.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/rtc.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/mode.p1: mode.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mode.p1.d 
+	@${RM} ${OBJECTDIR}/mode.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/mode.p1 mode.c 
+	@-${MV} ${OBJECTDIR}/mode.d ${OBJECTDIR}/mode.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/mode.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/config.p1: config.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.p1.d 
+	@${RM} ${OBJECTDIR}/config.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/config.p1 config.c 
+	@-${MV} ${OBJECTDIR}/config.d ${OBJECTDIR}/config.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/config.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/frame.p1: frame.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/frame.p1.d 
+	@${RM} ${OBJECTDIR}/frame.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/frame.p1 frame.c 
+	@-${MV} ${OBJECTDIR}/frame.d ${OBJECTDIR}/frame.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/frame.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
+${OBJECTDIR}/command.p1: command.c  nbproject/Makefile-${CND_CONF}.mk
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/command.p1.d 
+	@${RM} ${OBJECTDIR}/command.p1 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -fno-short-double -fno-short-float -O3 -fasmfile -maddrqual=ignore -D_XTAL_FREQ=19600000 -xassembler-with-cpp -Wa,-a -DXPRJ_XC8_PIC16F886=$(CND_CONF)  -msummary=-psect,-class,+mem,-hex,-file  -ginhx032 -Wl,--data-init -mno-keep-startup -mno-osccal -mno-resetbits -mno-save-resetbits -mno-download -mno-stackcall $(COMPARISON_BUILD)  -std=c99 -gdwarf-3 -mstack=compiled:auto:auto     -o ${OBJECTDIR}/command.p1 command.c 
+	@-${MV} ${OBJECTDIR}/command.d ${OBJECTDIR}/command.p1.d 
+	@${FIXDEPS} ${OBJECTDIR}/command.p1.d $(SILENT) -rsi ${MP_CC_DIR}../  
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -6,7 +6,18 @@
  */
 #include <xc.h>
 #include "peripherials.h"
+#include "adc.h"
 #include "interrupts.h"
+#include "timer.h"
+
+volatile struct DoorSwitch door;
+volatile struct ButtonQueue buttons;
+//Latch solenoid pulse (LATCH_PULSE_CFG)
+static uint16_t latchPulse = LATCH_PULSE_TIME;
+//Latch moves waiting for the L293D, wanted lock states and latch being pulsed
+static uint8_t latchPending = 0;
+static uint8_t latchLock = 0;
+static uint8_t latchMoving = 0;
 
 /**
  * Initialize peripherials (I/O)
@@ -35,10 +46,7 @@ void initPeripherials(void)
     //TODO: RC5 is used for debugging
     TRISC = 0xC0;
     //ADC config (right justified result)
-    ADCON1 = 0b10000000;    
-    //No CCP2
-    CCP2CON = 0x0;
-    
+    initADC();
     //Configure timer 1 (millis counter)
     T1CONbits.T1CKPS1 = 1;   // bits 5-4  Prescaler Rate Select bits
     T1CONbits.T1CKPS0 = 0;   // bit 4
@@ -46,32 +54,69 @@ void initPeripherials(void)
     T1CONbits.T1SYNC = 0;    // bit 2 Timer1 External Clock Input Synchronization Control bit...1 = Do not synchronize external clock input
     T1CONbits.TMR1CS = 0;    // bit 1 Timer1 Clock Source Select bit...0 = Internal clock (FOSC/4)
     T1CONbits.TMR1ON = 1;    // bit 0 enables timer
-    TMR1H = TMR1_H_PRES;     // preset for timer1 MSB register
-    TMR1L = TMR1_L_PRES;     // preset for timer1 LSB register
+    TMR1H = 0;
+    TMR1L = 0;
+    //CCP2 compare gives the millisecond tick
+    CCPR2H = (TMR1_PERIOD >> 8);
+    CCPR2L = (TMR1_PERIOD & 0xFF);
+    CCP2CON = CCP2_COMPARE_INT;
+    
+    //Door switch on RB0/INT, first edge is the one leaving current level
+    door.open = (DOOR_SWITCH != DOOR_CLOSED_LEVEL);
+    door.passages = 0;
+    OPTION_REGbits.INTEDG = !DOOR_SWITCH;
+    INTCONbits.INTF = 0;
+    INTCONbits.INTE = 1;
     
-    //Enable interrupt on timer 1
-    PIR1bits.TMR1IF = 0;
-    PIE1bits.TMR1IE = 1;
+    //Buttons wake us through interrupt-on-change on RB6/RB7
+    buttons.held = 0;
+    if(!GREEN_BTN){ buttons.held |= BTN_GREEN; }
+    if(!RED_BTN){ buttons.held |= BTN_RED; }
+    buttons.pending = false;
+    buttons.rIndex = 0;
+    buttons.uIndex = 0;
+    IOCB = 0xC0;
+    //Reading PORTB ends the mismatch condition
+    uint8_t portb = PORTB;
+    (void)portb;
+    INTCONbits.RBIF = 0;
+    INTCONbits.RBIE = 1;
+    
+    //Enable the tick interrupt
+    PIR2bits.CCP2IF = 0;
+    PIE2bits.CCP2IE = 1;
     INTCONbits.PEIE = 1;
     INTCONbits.GIE = 1;
 }
 
 
-uint16_t getLightSensor(void)
+ms_t doorClosedAt(void)
 {
-    //Start ADC on channel 0
-    ADCON0 = 0b10000001;
-    //Wait for capacitor to charge (PIC16F886 datasheet requires 20µs minimum)
-    __delay_us(ADC_ACQUISITION_DELAY_US);
-    ADCON0bits.GO_DONE = true;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += (ADRESH<<8);
-    //Keep ADC on
-    ADCON0 = 0x1;    
+    ms_t ret;
+    //The door interrupt may fire between the byte reads, read until stable
+    do{
+        ret = door.closedAt;
+    }while(ret != door.closedAt);
     return ret;
 }
 
+bool getButtonEvent(struct ButtonEvent* ev)
+{
+    if(buttons.rIndex == buttons.uIndex){
+        return false;
+    }
+    uint8_t i = buttons.uIndex;
+    ev->time = buttons.events[i].time;
+    ev->event = buttons.events[i].event;
+    buttons.uIndex = (i + 1) & (BTN_QUEUE - 1);
+    return true;
+}
+
+uint16_t getLightSensor(void)
+{
+    return adcRead(ADC_LIGHT);
+}
+
 void beep(void)
 {
     for(uint16_t i=0;i<200;++i){
@@ -83,9 +128,9 @@ void beep(void)
 }
 
 /**
- * Opens the green latch
+ * Start powering the green latch
  */
-bool lockGreenLatch(bool lock)
+void driveGreenLatch(bool lock)
 {
     CL_GL_ENABLE = 1;       //Enable channel 1/2
     RFID_RL_ENABLE = 0;     //Disable the 3/4 output
@@ -97,19 +142,25 @@ bool lockGreenLatch(bool lock)
         COMMON_LOCK = 0;    //Power the green lock
     }
     L293_LOGIC = 1;         //Power the logic
-    __delay_ms(500);
+}
+
+/**
+ * Stop powering the latches
+ */
+void releaseLatches(void)
+{
     L293_LOGIC = 0;         //Power the logic
-    CL_GL_ENABLE = 0;       //Enable channel 1/2
+    CL_GL_ENABLE = 0;       //Disable channel 1/2
+    RFID_RL_ENABLE = 0;     //Disable channel 3/4
     GREEN_LOCK = 1;         //Put locks to 1 to avoid burning L293_LOGIC I/O
     RED_LOCK = 1;           //Put locks to 1 to avoid burning L293_LOGIC I/O
     COMMON_LOCK = 1;        //Put locks to 1 to avoid burning L293_LOGIC I/O
-    return lock;
 }
 
 /**
- * Opens the green latch
+ * Start powering the red latch
  */
-bool lockRedLatch(bool lock)
+static void driveRedLatch(bool lock)
 {
     RFID_RL_ENABLE = 1;     //Enable channel 1/2
     RFID_EXCT = 1;          //Force RFID to 1 (less consumption)
@@ -123,13 +174,75 @@ bool lockRedLatch(bool lock)
         COMMON_LOCK = 0;    //Power the red lock
     }
     L293_LOGIC = 1;         //Power the logic
-    __delay_ms(500);
-    L293_LOGIC = 0;         //Power the logic
-    CL_GL_ENABLE = 0;       //Disable channel 1/2
-    RFID_RL_ENABLE = 0;     //Disable channel 3/4
-    GREEN_LOCK = 1;         //Put locks to 1 to avoid burning L293_LOGIC I/O
-    RED_LOCK = 1;           //Put locks to 1 to avoid burning L293_LOGIC I/O
-    COMMON_LOCK = 1;        //Put locks to 1 to avoid burning L293_LOGIC I/O
+}
+
+void moveLatches(uint8_t latches, uint8_t lock)
+{
+    latchPending |= latches;
+    latchLock = (uint8_t)((latchLock & ~latches) | (lock & latches));
+}
+
+bool serviceLatches(void)
+{
+    if(latchMoving != 0){
+        if(timerRunning(TIMER_LATCH)){
+            return true;
+        }
+        releaseLatches();
+        latchMoving = 0;
+    }
+    //Red first, both share the L293D so only one is pulsed at a time
+    if(latchPending & LATCH_RED){
+        latchMoving = LATCH_RED;
+        driveRedLatch((latchLock & LATCH_RED) != 0);
+    }else if(latchPending & LATCH_GREEN){
+        latchMoving = LATCH_GREEN;
+        driveGreenLatch((latchLock & LATCH_GREEN) != 0);
+    }else{
+        return false;
+    }
+    latchPending &= (uint8_t)~latchMoving;
+    //A timer is used as __delay_ms needs a constant
+    timerStart(TIMER_LATCH, latchPulse, false);
+    return true;
+}
+
+bool latchesBusy(void)
+{
+    return (latchMoving != 0) || (latchPending != 0);
+}
+
+void finishLatches(void)
+{
+    while(serviceLatches()){}
+}
+
+/**
+ * Opens the green latch
+ */
+bool lockGreenLatch(bool lock)
+{
+    moveLatches(LATCH_GREEN, lock ? LATCH_GREEN : 0);
+    finishLatches();
+    return lock;
+}
+
+/**
+ * Opens the red latch
+ */
+bool lockRedLatch(bool lock)
+{
+    moveLatches(LATCH_RED, lock ? LATCH_RED : 0);
+    finishLatches();
     return lock;
 }
 
+void setLatchPulse(uint16_t ms)
+{
+    latchPulse = ms;
+}
+
+uint16_t getLatchPulse(void)
+{
+    return latchPulse;
+}
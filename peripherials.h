@@ -34,6 +34,7 @@
 #include <xc.h> // include processor files - each processor file is guarded.  
 #include <stdbool.h>       /* For true/false definition */
 #include <stdint.h>
+#include "interrupts.h"
 
 //RFID demodulated stream input
 #define RFID_STREAM PORTAbits.RA2
@@ -70,24 +71,95 @@
 //RFID field frequency
 #define RFID_FREQ 134200
 
-// ADC acquisition time as per PIC16F886 datasheet (20µs minimum)
-#define ADC_ACQUISITION_DELAY_US 20
+// DOOR_SWITCH level when the flap hangs at rest
+#define DOOR_CLOSED_LEVEL 0
+// Door switch edges closer than this are treated as contact bounce (ms)
+#define DOOR_DEBOUNCE_MS 20
 
-// Timer 1 is configured with a 1:4 scaler
+// Flap movement recorded by the RB0/INT interrupt
+struct DoorSwitch{
+    ms_t swungAt;       // Time the flap left its rest position
+    ms_t closedAt;      // Time the flap came back after a swing
+    uint8_t passages;   // Number of completed swings (wraps)
+    bool open;          // Flap is currently away from rest
+};
+extern volatile struct DoorSwitch door;
+
+/**
+ * Get the time the flap last came back to rest
+ * Safe against the door interrupt updating it mid-read
+ * @return door.closedAt
+ */
+ms_t doorClosedAt(void);
+
+// Button bits used in button events
+#define BTN_GREEN 0x1
+#define BTN_RED 0x2
+// Set in a button event when the button was released
+#define BTN_RELEASE 0x80
+// Buttons must be stable this long before an edge is queued (ms)
+#define BTN_DEBOUNCE_MS 20
+// Number of queued button events, must be a power of 2
+#define BTN_QUEUE 4
+// Default gesture durations (ms), see the *_CFG settings in cat.h
+// Green held longer than this enters learn mode
+#define BTN_LEARN_HOLD 10000
+// Red held longer than this toggles vet mode
+#define BTN_VET_HOLD 5000
+// Red pressed shorter than this toggles night mode
+#define BTN_NIGHT_PRESS 2000
+// Both held longer than this clears all cats
+#define BTN_CLEAR_HOLD 30000
+
+// A debounced press or release
+struct ButtonEvent{
+    ms_t time;          // millis() at the first edge, full width as holds may pass 65s
+    uint8_t event;      // BTN_GREEN or BTN_RED, ORed with BTN_RELEASE
+};
+
+// Button events produced by the RB6/RB7 interrupt-on-change and Timer 1
+struct ButtonQueue{
+    ms_t changedAt;     // Time of the first edge of a pending change
+    bool pending;       // An edge is waiting for the debounce time
+    uint8_t held;       // Debounced pressed buttons
+    uint8_t rIndex;
+    uint8_t uIndex;
+    struct ButtonEvent events[BTN_QUEUE];
+};
+extern volatile struct ButtonQueue buttons;
+
+// Latches for moveLatches(), pulsed in this order
+#define LATCH_RED 0x1
+#define LATCH_GREEN 0x2
+// Default time the L293D powers a latch solenoid to move it (ms)
+#define LATCH_PULSE_TIME 500
+// Default maximum time to keep door open if the flap is never passed (ms)
+#define OPEN_TIME 5000
+// Default time to wait after the flap came back to rest before relocking (ms)
+#define RELOCK_DELAY 500
+
+
+// Timer 1 is configured with a 1:4 scaler and runs freely
 // Given the CLK freq of 19,600,000 Hz, Fosc/4 = 4,900,000Hz
-//(Fosc/4)/Prescaler = 1,225,000 Hz
-// 1E-3/((1/(Fosc/4)/Prescaler)-1 = 1224
-// 0xFFFF - 1225 = 64331 -> 0xFB37
-//Timer 1 high bits preset
-#define TMR1_H_PRES 0xFB
-//Timer 1 low bits preset
-#define TMR1_L_PRES 0x37
+//(Fosc/4)/Prescaler = 1,225,000 Hz -> 1225 counts per ms
+// CCP2 compare raises the tick, CCPR2 is advanced by one period each
+// time, so the interrupt latency does not add up
+#define TMR1_PERIOD 1225
+// CCP2 compare mode, software interrupt only
+#define CCP2_COMPARE_INT 0b00001010
 
 /**
  * Initialize peripherials (I/O)
  */
 void initPeripherials(void);
 
+/**
+ * Get the oldest button event
+ * @param ev Event read
+ * @return true if an event was available
+ */
+bool getButtonEvent(struct ButtonEvent* ev);
+
 /**
  * Read the light sensor
  * @return The ADC value
@@ -109,5 +181,54 @@ bool lockGreenLatch(bool lock);
  */
 bool lockRedLatch(bool lock);
 
+/**
+ * Queue latch moves without waiting for the pulses
+ * Pulses are sent one latch at a time from serviceLatches()
+ * @param latches LATCH_RED and/or LATCH_GREEN
+ * @param lock Bits of latches to lock, the others are unlocked
+ */
+void moveLatches(uint8_t latches, uint8_t lock);
+
+/**
+ * Advance the queued latch moves, call from the main loop
+ * @return true while a latch is being pulsed or waiting
+ */
+bool serviceLatches(void);
+
+/**
+ * Check for queued or moving latches
+ * @return true until every queued latch pulse is done
+ */
+bool latchesBusy(void);
+
+/**
+ * Wait for all queued latch moves
+ */
+void finishLatches(void);
+
+/**
+ * Set how long the latch solenoids are powered
+ * @param ms Pulse length (ms)
+ */
+void setLatchPulse(uint16_t ms);
+
+/**
+ * Get how long the latch solenoids are powered
+ * @return Pulse length (ms)
+ */
+uint16_t getLatchPulse(void);
+
+/**
+ * Start powering the green latch and return immediately
+ * The caller must call releaseLatches() once getLatchPulse() has elapsed
+ * @param lock true to lock, false to unlock
+ */
+void driveGreenLatch(bool lock);
+
+/**
+ * Stop powering the latches and put L293D outputs to a safe state
+ */
+void releaseLatches(void);
+
 #endif	/* XC_HEADER_TEMPLATE_H */
 
@@ -0,0 +1,194 @@
+/*
+ * File:   power.c
+ * Comments: Idle policy, sleeps the core or slows its clock between
+ *           scheduled work
+ */
+
+#include <xc.h>
+#include "power.h"
+#include "peripherials.h"
+#include "serial.h"
+#include "adc.h"
+
+static uint8_t idlePolicy = 0;
+static bool slowClock = false;
+static ms_t sleepTime = 0;
+static ms_t slowTime = 0;
+static ms_t slowSince = 0;
+static ms_t lastActivity = 0;
+
+void setIdlePolicy(uint8_t policy)
+{
+    idlePolicy = policy;
+    //Watchdog prescaler belongs to WDT only, Timer 0 is not used
+    OPTION_REGbits.PSA = 0;
+    if(!(policy & IDLE_SLOW_CLOCK)){
+        clockFast();
+    }
+}
+
+/**
+ * Wait for the UART to be idle
+ * Changing the baud divider in the middle of a byte corrupts it
+ */
+static void waitSerialIdle(void)
+{
+    serialFlush();
+    while(!BAUDCTLbits.RCIDL){}
+}
+
+/**
+ * Move the pending tick to a new Timer 1 rate
+ * The counts left in the current tick are scaled, so a clock switch
+ * neither stretches nor shortens it. Called with interrupts disabled,
+ * right after the clock switch.
+ * @param period New counts per ms
+ */
+static void setTickPeriod(uint16_t period)
+{
+    //A compare that already matched is advanced by the ISR at the new period
+    if(!CCP2IF){
+        uint8_t high;
+        uint8_t low;
+        do{
+            high = TMR1H;
+            low = TMR1L;
+        }while(high != TMR1H);
+        uint16_t now = ((uint16_t)high << 8) | low;
+        uint16_t left = (((uint16_t)CCPR2H << 8) | CCPR2L) - now;
+        uint16_t next = now + (uint16_t)((uint32_t)left * period / tmr1Period);
+        CCPR2L = (uint8_t)next;
+        CCPR2H = (uint8_t)(next >> 8);
+    }
+    tmr1Period = period;
+}
+
+void clockFast(void)
+{
+    if(!slowClock){
+        return;
+    }
+    waitSerialIdle();
+    //No tick while the rate changes under the compare
+    di();
+    //Back to FOSC (HS), the core keeps running on HFINTOSC until the
+    //crystal has started. Fail-safe clock monitor ends the wait if it never does
+    OSCCONbits.SCS = 0;
+    while(!OSCCONbits.OSTS && !PIR2bits.OSFIF){}
+    BRG_WRITE(getBaudDivider());
+    setTickPeriod(TMR1_PERIOD);
+    ei();
+    slowClock = false;
+    slowTime += millis()-slowSince;
+}
+
+void clockSlow(void)
+{
+    if(slowClock || !(idlePolicy & IDLE_SLOW_CLOCK) || !SLOW_BAUD_OK ||
+            (getBaudDivider() != DIVIDER) || autoBaudPending()){
+        return;
+    }
+    waitSerialIdle();
+    di();
+    OSCCONbits.IRCF = CLOCK_SLOW_IRCF;
+    OSCCONbits.SCS = 1;
+    BRG_WRITE(DIVIDER_SLOW);
+    setTickPeriod(TMR1_SLOW_PERIOD);
+    ei();
+    slowClock = true;
+    slowSince = millis();
+}
+
+/**
+ * Tell whether something still needs the clock running
+ * @return true if the core must stay awake
+ */
+static bool isBusy(void)
+{
+    //Serial traffic, transmit in progress or receiver active
+    if(byteAvail() || txPending() || autoBaudPending() || !TXSTAbits.TRMT || !BAUDCTLbits.RCIDL){
+        lastActivity = millis();
+        return true;
+    }
+    if((millis()-lastActivity) < IDLE_AWAKE_MS){
+        return true;
+    }
+    //Button debounce and hold times are measured with Timer 1
+    if(buttons.pending || (buttons.held != 0)){
+        return true;
+    }
+    //Latch pulses are timed with Timer 1
+    if(latchesBusy()){
+        return true;
+    }
+    //Flap swinging
+    if(door.open){
+        return true;
+    }
+    //The ADC clock stops in Sleep
+    if(adc.busy){
+        return true;
+    }
+    return false;
+}
+
+bool idleSleep(uint8_t wdtps)
+{
+    if(!(idlePolicy & IDLE_SLEEP) || isBusy()){
+        return false;
+    }
+    //Wake-up sources are handled here, not in the ISR
+    INTCONbits.GIE = 0;
+    //Falling edge on RX wakes the EUSART
+    BAUDCTLbits.WUE = 1;
+    WDTCON = (uint8_t)((wdtps << 1) | 0x1);
+    //Sets PD, SLEEP clears it unless a wake-up flag was already pending
+    CLRWDT();
+    SLEEP();
+    NOP();
+    WDTCON = 0x0;
+    //Account the time Timer 1 missed. A watchdog wake-up is a full period,
+    //an early wake-up (door, button, UART) happened at an unknown point of
+    //it and is charged half, at most half a period off either way
+    if(!STATUSbits.nPD){
+        ms_t slept = IDLE_WDT_MS(wdtps);
+        if(STATUSbits.nTO){
+            slept >>= 1;
+        }
+        addMillis(slept);
+        sleepTime += slept;
+    }
+    if(!BAUDCTLbits.WUE){
+        //Woken by the UART, discard the wake-up character
+        uint8_t dummy = RCREG;
+        (void)dummy;
+        lastActivity = millis();
+    }else{
+        BAUDCTLbits.WUE = 0;
+    }
+    INTCONbits.GIE = 1;
+    return true;
+}
+
+void relax(uint8_t wdtps)
+{
+    //Slow first, waking from Sleep on HFINTOSC needs no crystal start-up
+    clockSlow();
+    if(!idleSleep(wdtps)){
+        ms_t t = millis();
+        while(((millis()-t) < IDLE_RELAX_MS) && !byteAvail()){}
+    }
+}
+
+ms_t getSleepTime(void)
+{
+    return sleepTime;
+}
+
+ms_t getSlowTime(void)
+{
+    if(slowClock){
+        return slowTime + (millis()-slowSince);
+    }
+    return slowTime;
+}
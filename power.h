@@ -0,0 +1,107 @@
+/* 
+ * File:   power.h
+ * Comments: Idle policy, sleeps the core or slows its clock between
+ *           scheduled work
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef POWER_INCLUDED_H
+#define	POWER_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+#include "interrupts.h"
+#include "serial.h"
+
+// Idle policy bits (IDLE_CFG)
+// Sleep between scheduled work
+#define IDLE_SLEEP 0x1
+// Run from the internal oscillator between scheduled work
+#define IDLE_SLOW_CLOCK 0x2
+
+// Internal oscillator used when idle, HFINTOSC at 4 MHz (IRCF = 110)
+#define CLOCK_SLOW_FREQ 4000000UL
+#define CLOCK_SLOW_IRCF 0x6
+// Timer 1 keeps its 1:4 prescaler when slow
+// (4,000,000/4)/4 = 250,000 Hz -> 250 counts per ms
+#define TMR1_SLOW_PERIOD 250
+// UART divider when slow: (4000000 + 19200) / 38400 - 1 = 103 (0.16% error)
+#define DIVIDER_SLOW BAUD_DIVIDER(CLOCK_SLOW_FREQ, BAUD_RATE)
+// High rates cannot be reached from the internal oscillator, the slow
+// clock is then not used. It is neither used after auto-baud
+#define SLOW_BAUD_OK (BAUD_ERROR(CLOCK_SLOW_FREQ, BAUD_RATE) <= BAUD_ERROR_MAX)
+
+// Time between two passes of the main loop when awake (ms)
+#define IDLE_RELAX_MS 20
+
+// Timer 1 runs from Fosc/4 and stops in Sleep, and the T1OSC pins are
+// used by RC0/RC1 on this board. The periodic wake-up is the watchdog,
+// clocked by the 31 kHz LFINTOSC and prescaled by WDTCON.WDTPS.
+// WDTPS 0 is 1:32, every step doubles the period.
+#define IDLE_WDT_MS(wdtps) ((ms_t)((32UL << (wdtps)) * 1000UL / 31000UL))
+
+// Sleep between two RFID polls, 1:512 (~16ms)
+#define IDLE_POLL 0x4
+// Sleep when there is nothing to poll, 1:4096 (~132ms)
+#define IDLE_LONG 0x7
+
+// Stay awake this long after serial activity (ms)
+// The byte that wakes the UART is lost, the host resends it
+#define IDLE_AWAKE_MS 2000
+
+/**
+ * Select what is done when idle
+ * @param policy IDLE_SLEEP and/or IDLE_SLOW_CLOCK
+ */
+void setIdlePolicy(uint8_t policy);
+
+/**
+ * Run from the HS crystal
+ * Must be called before anything using __delay_*() or RFID timing.
+ * Waits for the crystal start-up (OST) to complete.
+ */
+void clockFast(void);
+
+/**
+ * Run from the internal oscillator, if allowed by the idle policy
+ * millis() and the UART stay correct, __delay_*() does not.
+ */
+void clockSlow(void);
+
+/**
+ * Wait for the next main loop pass in the cheapest allowed way
+ * Sleeps if possible, otherwise waits on the slow clock for up to
+ * IDLE_RELAX_MS or until a byte is received
+ * @param wdtps Watchdog prescaler giving the sleep period (IDLE_POLL, IDLE_LONG)
+ */
+void relax(uint8_t wdtps);
+
+/**
+ * Sleep until the next scheduled work if nothing is pending
+ * Wakes on watchdog, door switch (RB0), buttons (RB6/RB7) and UART receive
+ * Timer 1 stops in Sleep: a watchdog wake-up adds a full period to
+ * millis(), an early one half a period, so each early wake-up may move
+ * millis() by up to half a period (66ms at IDLE_LONG) either way
+ * @param wdtps Watchdog prescaler giving the sleep period (IDLE_POLL, IDLE_LONG)
+ * @return true if the core slept
+ */
+bool idleSleep(uint8_t wdtps);
+
+/**
+ * Get time spent asleep
+ * Early wake-ups are counted as half a watchdog period, see idleSleep()
+ * @return Milliseconds asleep since boot
+ */
+ms_t getSleepTime(void);
+
+/**
+ * Get time spent on the internal oscillator
+ * @return Milliseconds on the slow clock since boot
+ */
+ms_t getSlowTime(void);
+
+#endif	/* POWER_INCLUDED_H */
+
@@ -12,40 +12,32 @@
 #include "rfid.h"
 #include "peripherials.h"
 #include "interrupts.h"
+#include "adc.h"
+#include "timer.h"
 
 // RFID-specific constants
 #define RFID_SYNC_TIMEOUT_MS 100
-#define RFID_ADC_THRESHOLD 512
-#define RFID_CARRIER_THRESHOLD 200
 #define RFID_STABILIZATION_DELAY_MS 2
 
 static bool nextBit = false;
+//Demodulation thresholds (RFID_BIT_CFG, RFID_CARRIER_CFG)
+static uint16_t bitThreshold = RFID_ADC_THRESHOLD;
+static uint16_t carrierThreshold = RFID_CARRIER_THRESHOLD;
 
-uint16_t readRFIDADCS(void){    
-    ADCON0 = 0b10001001;
-    // Wait for ADC acquisition time (PIC16F886 datasheet requires 20µs minimum)
-    __delay_us(ADC_ACQUISITION_DELAY_US);
-    ADCON0bits.GO_DONE = 1;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += ((ADRESH & 0x3) <<8) ;            
-    return ret;
-}
-
-uint16_t readRFIDADC(void){
-    ADCON0 = 0b00001001;
-    // Wait for ADC acquisition time (PIC16F886 datasheet requires 20µs minimum)
-    __delay_us(ADC_ACQUISITION_DELAY_US);
-    ADCON0bits.GO_DONE = 1;
-    while(ADCON0bits.GO_DONE){}
-    uint16_t ret = ADRESL;
-    ret += ((ADRESH & 0x3) <<8) ;   
-    return ret;
-}
+//Adaptive poll scheduler
+static uint16_t pollMin = RFID_POLL_MIN;
+static uint16_t pollMax = RFID_POLL_MAX;
+static uint16_t pollInterval = RFID_POLL_MIN;
+//No cat expected, back off up to RFID_POLL_QUIET
+static bool pollQuiet = false;
+//Start of the last poll
+static ms_t lastPoll = 0;
+//Last door, button or tag activity
+static ms_t lastActivity = 0;
 
 bool readRFIDBitADC(void){
     
-    return readRFIDADC() > RFID_ADC_THRESHOLD;
+    return adcRead(ADC_RFID) > bitThreshold;
 }
 
 bool readBit(){
@@ -71,8 +63,6 @@ void setRFIDPWM(bool on)
 
         //Power the analog op-amp
         LM324_PWR = 1;
-        //Enable ADC                
-        ADCON0bits.ADON = 1;
         //Disable output
         TRISCbits.TRISC2 = 1;
         //we will use a prescaler of 1:1
@@ -112,10 +102,10 @@ void setRFIDPWM(bool on)
 
 bool waitEdge(){
     bool v = readRFIDBitADC();
-    ms_t start = millis();
+    timerStart(TIMER_RFID_EDGE, RFID_SYNC_TIMEOUT_MS, false);
     // Wait for edge with timeout to prevent infinite loop
     while(v == readRFIDBitADC()){
-        if((millis() - start) > RFID_SYNC_TIMEOUT_MS){
+        if(!timerRunning(TIMER_RFID_EDGE)){
             return !v; // Timeout - return opposite of initial value
         }
     }
@@ -128,9 +118,9 @@ bool waitEdge(){
  */
 uint8_t syncRFID(void){
     //Wait for header    
-    ms_t t = millis();
-    while((millis()-t) < RFID_SYNC_TIMEOUT_MS){
-        if(readRFIDADCS() > RFID_CARRIER_THRESHOLD){
+    timerStart(TIMER_RFID_SYNC, RFID_SYNC_TIMEOUT_MS, false);
+    while(timerRunning(TIMER_RFID_SYNC)){
+        if(adcRead(ADC_RFID) > carrierThreshold){
             continue;                    
         }
         nextBit = waitEdge();        
@@ -221,5 +211,78 @@ uint8_t readRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
     }
     //Put excitation off
     setRFIDPWM(false);
+    if(r != NO_HEADER){
+        //A tag is in the field, even if it was misread
+        pollActivity();
+    }
     return r;
+}
+
+void setPollLimits(uint16_t min, uint16_t max)
+{
+    if((min == 0) || (min == 0xFFFF)){
+        min = RFID_POLL_MIN;
+    }
+    if((max == 0) || (max == 0xFFFF)){
+        max = RFID_POLL_MAX;
+    }
+    if(max < min){
+        max = min;
+    }
+    pollMin = min;
+    pollMax = max;
+    pollInterval = min;
+}
+
+void setRFIDThresholds(uint16_t bit, uint16_t carrier)
+{
+    bitThreshold = bit;
+    carrierThreshold = carrier;
+}
+
+void setPollQuiet(bool quiet)
+{
+    pollQuiet = quiet;
+    if(!quiet && (pollInterval > pollMax)){
+        pollInterval = pollMax;
+    }
+}
+
+void pollActivity(void)
+{
+    lastActivity = millis();
+    pollInterval = pollMin;
+}
+
+bool pollDue(void)
+{
+    ms_t now = millis();
+    if((now-lastPoll) < pollInterval){
+        return false;
+    }
+    lastPoll = now;
+    if((now-lastActivity) > RFID_POLL_HOLD){
+        //Idle, back off up to the slowest rate
+        uint16_t limit = pollMax;
+        if(pollQuiet && (limit < RFID_POLL_QUIET)){
+            limit = RFID_POLL_QUIET;
+        }
+        if(pollInterval < (limit/2)){
+            pollInterval <<= 1;
+        }else{
+            pollInterval = limit;
+        }
+    }
+    return true;
+}
+
+ms_t pollWait(void)
+{
+    ms_t elapsed = millis()-lastPoll;
+    return (elapsed < pollInterval) ? (pollInterval-elapsed) : 0;
+}
+
+uint16_t getPollInterval(void)
+{
+    return pollInterval;
 }
\ No newline at end of file
@@ -11,12 +11,27 @@
 #define	RFID_INCLUDED_H
 
 #include <xc.h> // include processor files - each processor file is guarded.  
+#include "interrupts.h"
 
 #define NO_CARRIER 1
 #define NO_HEADER 2
 #define BAD_START 3
 #define BAD_CRC 4
 
+// Default demodulated level above which a sample is a 1 (ADC counts)
+#define RFID_ADC_THRESHOLD 512
+// Default level below which the carrier is seen as modulated (ADC counts)
+#define RFID_CARRIER_THRESHOLD 200
+
+// Fastest poll interval, used after door, button or tag activity (ms)
+#define RFID_POLL_MIN 20
+// Slowest poll interval, reached after a long idle period (ms)
+#define RFID_POLL_MAX 500
+// Time without activity before the poll interval starts doubling (ms)
+#define RFID_POLL_HOLD 10000
+// Slowest poll interval when every stored cat is known inside (ms)
+#define RFID_POLL_QUIET 2000
+
 /**
  * Read RFID tag
  * @param id Array to store ID of tag
@@ -30,5 +45,50 @@ uint8_t readRFID(uint8_t* id, uint8_t len, uint16_t* crcComputed,
 
 void setRFIDPWM(bool on);
 
+/**
+ * Set the poll interval limits
+ * 0 or 0xFFFF (unprogrammed) selects the default limit
+ * @param min Interval used after activity (ms)
+ * @param max Interval reached after idle (ms), raised to min if lower
+ */
+void setPollLimits(uint16_t min, uint16_t max);
+
+/**
+ * Set the demodulation thresholds
+ * @param bit Level above which a bit is read as 1 (ADC counts)
+ * @param carrier Level under which the carrier is considered present
+ */
+void setRFIDThresholds(uint16_t bit, uint16_t carrier);
+
+/**
+ * Let the poll interval back off further while no cat is expected
+ * @param quiet true when every stored cat is known inside
+ */
+void setPollQuiet(bool quiet);
+
+/**
+ * Report activity near the flap, polls at the fastest rate again
+ */
+void pollActivity(void);
+
+/**
+ * Check if the tag should be read now
+ * Schedules the next poll and backs off once idle for RFID_POLL_HOLD
+ * @return true if readRFID() should be called
+ */
+bool pollDue(void);
+
+/**
+ * Get time until the next poll
+ * @return Milliseconds before pollDue() returns true
+ */
+ms_t pollWait(void);
+
+/**
+ * Get the current poll interval
+ * @return Interval between two polls (ms)
+ */
+uint16_t getPollInterval(void);
+
 #endif	/* XC_HEADER_TEMPLATE_H */
 
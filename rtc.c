@@ -0,0 +1,137 @@
+/*
+ * File:   rtc.c
+ * Comments: Software real-time clock kept from the millisecond tick and
+ *           mode change schedule stored in EEPROM
+ */
+
+#include <xc.h>
+#include "rtc.h"
+#include "interrupts.h"
+#include "config.h"
+
+static uint32_t seconds = 0;
+//Broken down time of day, avoids a division every second
+static uint16_t minuteOfDay = 0;
+static uint8_t second = 0;
+static uint16_t day = 0;
+static bool valid = false;
+//Time set, report the current minute again so its schedule is checked
+static bool minuteDue = false;
+//Minute the schedule entry reported last was due
+static uint32_t scheduleDone = SCHED_NEVER;
+//Milliseconds not yet counted as a second
+static int32_t msAcc = 0;
+static ms_t lastUpdate = 0;
+//Drift correction, accumulated in microseconds
+static int16_t drift = 0;
+static int32_t driftAcc = 0;
+
+void initRTC(void)
+{
+    setDrift((int16_t)configValue(RTC_DRIFT_CFG));
+    lastUpdate = millis();
+}
+
+void setTime(uint32_t s)
+{
+    seconds = s;
+    day = (uint16_t)(s / SECONDS_PER_DAY);
+    uint32_t t = s % SECONDS_PER_DAY;
+    minuteOfDay = (uint16_t)(t / 60);
+    second = (uint8_t)(t % 60);
+    //The entry in force at the new time is reported again
+    scheduleDone = SCHED_NEVER;
+    msAcc = 0;
+    lastUpdate = millis();
+    valid = true;
+    minuteDue = true;
+}
+
+uint32_t getTime(void)
+{
+    return seconds;
+}
+
+bool timeValid(void)
+{
+    return valid;
+}
+
+uint16_t getMinuteOfDay(void)
+{
+    return minuteOfDay;
+}
+
+void setDrift(int16_t ppm)
+{
+    drift = ppm;
+    driftAcc = 0;
+}
+
+int16_t getDrift(void)
+{
+    return drift;
+}
+
+bool updateRTC(void)
+{
+    bool newMinute = minuteDue;
+    minuteDue = false;
+    ms_t now = millis();
+    msAcc += (int32_t)(now - lastUpdate);
+    lastUpdate = now;
+    while(msAcc >= 1000){
+        msAcc -= 1000;
+        ++seconds;
+        //A fast tick counts too many ms per real second, take them back
+        driftAcc += drift;
+        while(driftAcc >= 1000){
+            driftAcc -= 1000;
+            msAcc -= 1;
+        }
+        while(driftAcc <= -1000){
+            driftAcc += 1000;
+            msAcc += 1;
+        }
+        if(++second >= 60){
+            second = 0;
+            if(++minuteOfDay >= MINUTES_PER_DAY){
+                minuteOfDay = 0;
+                ++day;
+            }
+            newMinute = true;
+        }
+    }
+    return newMinute;
+}
+
+uint8_t scheduledMode(void)
+{
+    uint8_t mode = SCHED_NONE;
+    uint16_t latest = MINUTES_PER_DAY;
+    for(uint8_t i=0;i<SCHEDULE_ENTRIES;++i){
+        uint16_t entry = getConfiguration(SCHEDULE_CFG + i);
+        uint16_t minute = SCHED_MINUTE(entry);
+        if((entry == 0xFFFF) || (minute >= MINUTES_PER_DAY)){
+            continue;
+        }
+        //Minutes since the entry was due, a later one was due yesterday
+        uint16_t age = (minute <= minuteOfDay) ? (minuteOfDay - minute) :
+                (minuteOfDay + MINUTES_PER_DAY - minute);
+        //The first of several entries for the same minute wins
+        if(age < latest){
+            latest = age;
+            mode = SCHED_MODE(entry);
+        }
+    }
+    if(mode == SCHED_NONE){
+        return SCHED_NONE;
+    }
+    //Counted from the day before 1970, an entry due yesterday never wraps
+    uint32_t due = ((uint32_t)day + 1) * MINUTES_PER_DAY + minuteOfDay - latest;
+    if(due == scheduleDone){
+        return SCHED_NONE;
+    }
+    scheduleDone = due;
+    return mode;
+}
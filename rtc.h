@@ -0,0 +1,92 @@
+/* 
+ * File:   rtc.h
+ * Comments: Software real-time clock kept from the millisecond tick and
+ *           mode change schedule stored in EEPROM
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef RTC_INCLUDED_H
+#define	RTC_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SECONDS_PER_DAY 86400UL
+#define MINUTES_PER_DAY 1440
+
+// Number of schedule entries, stored from configuration index SCHEDULE_CFG
+#define SCHEDULE_ENTRIES 8
+
+// Schedule entry: bits 0-10 minute of day, bits 11-14 mode
+// 0xFFFF (unprogrammed) or a minute past the end of day disables it
+#define SCHED_ENTRY(minute, mode) ((uint16_t)(((uint16_t)(mode) << 11) | (minute)))
+#define SCHED_MINUTE(entry) ((entry) & 0x07FF)
+#define SCHED_MODE(entry) ((uint8_t)(((entry) >> 11) & 0x0F))
+// No mode change due
+#define SCHED_NONE 0xFF
+// No schedule entry reported since the time was set
+#define SCHED_NEVER 0xFFFFFFFFUL
+
+/**
+ * Load the drift correction
+ */
+void initRTC(void);
+
+/**
+ * Set the time
+ * The next updateRTC() reports a new minute so the schedule is checked
+ * @param seconds Seconds since 1970-01-01 00:00, local time
+ */
+void setTime(uint32_t seconds);
+
+/**
+ * Get the time
+ * @return Seconds since 1970-01-01 00:00 (local), counted from boot if never set
+ */
+uint32_t getTime(void);
+
+/**
+ * Check if the time was set since boot
+ * @return true once setTime() was called
+ */
+bool timeValid(void);
+
+/**
+ * Get the minute of the day
+ * @return 0-1439
+ */
+uint16_t getMinuteOfDay(void);
+
+/**
+ * Set the drift correction
+ * @param ppm Parts per million the tick runs fast (positive) or slow
+ */
+void setDrift(int16_t ppm);
+
+/**
+ * Get the drift correction
+ * @return ppm
+ */
+int16_t getDrift(void);
+
+/**
+ * Advance the clock from the millisecond tick
+ * Called from the main loop
+ * @return true when a new minute started or the time was set
+ */
+bool updateRTC(void);
+
+/**
+ * Get the schedule entry in force, once
+ * This is the latest entry at or before the current minute, wrapping to
+ * the day before. It is reported once, so an entry passed while the main
+ * loop was blocked, or skipped by setTime(), is still applied.
+ * Only meaningful once the time was set
+ * @return Mode to switch to or SCHED_NONE
+ */
+uint8_t scheduledMode(void);
+
+#endif	/* RTC_INCLUDED_H */
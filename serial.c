@@ -9,11 +9,21 @@
 #include <xc.h>
 #include <stdio.h>
 #include "interrupts.h"
+#include "timer.h"
+#include "peripherials.h"
 
-#define SERIAL_TIMEOUT 5
 
 volatile struct RingBuffer rxBuffer;
 volatile struct UartErrors uartErrors;
+volatile struct TxBuffer txBuffer;
+static uint8_t txPolicy = TX_BLOCK;
+static uint8_t protocol = PROTO_TEXT;
+//Output classes sent (OUTPUT_CFG)
+static uint8_t outputMask = OUT_ALL;
+//Divider at the crystal clock, changed by auto-baud
+static uint16_t baudDivider = DIVIDER;
+//Auto-baud detection running, the baud generator is a counter
+static bool autoBaud = false;
 
 
 void initSerial(void)
@@ -21,8 +31,10 @@ void initSerial(void)
    //Pin for UART
    TRISC7 = 1;
    TRISC6 = 1;
-   //Clock divider
-   SPBRG = DIVIDER;
+   //16-bit clock divider
+   BAUDCTLbits.BRG16 = 1;
+   baudDivider = DIVIDER;
+   BRG_WRITE(baudDivider);
    //Receive control register
    RCSTA = 0x0;
    //Serial port enabled
@@ -36,84 +48,300 @@ void initSerial(void)
    
    rxBuffer.rIndex = 0;
    rxBuffer.uIndex = 0;
+   rxBuffer.rts = false;
+   SER_INT = 0;
+   //TX interrupt is enabled by putch while the ring holds characters
+   TXIE = 0;
+   txBuffer.rIndex = 0;
+   txBuffer.wIndex = 0;
    
    // Initialize error counters
    uartErrors.framingErrors = 0;
    uartErrors.overrunErrors = 0;
    uartErrors.bufferOverflows = 0;
-   
-   // Print startup banner to indicate serial is ready
+   uartErrors.txDrops = 0;
+}
+
+void printBanner(void)
+{
+   if(protocol != PROTO_TEXT){
+       return;
+   }
    // Small delay to let UART stabilize
    __delay_ms(10);
    printf("\r\n");
    printf("========================================\r\n");
    printf("PetSafe Cat Flap - Alternative Firmware\r\n");
    printf("Serial Interface Ready\r\n");
-   printf("Baud Rate: %d bps\r\n", BAUD_RATE);
+   printf("Baud Rate: %lu bps (actual %lu, error %u.%02u%%)\r\n", (unsigned long)BAUD_RATE,
+          (unsigned long)BAUD_ACTUAL(_XTAL_FREQ, DIVIDER),
+          (unsigned int)(BAUD_ERROR(_XTAL_FREQ, BAUD_RATE) / 100),
+          (unsigned int)(BAUD_ERROR(_XTAL_FREQ, BAUD_RATE) % 100));
    printf("========================================\r\n");
    printf("\r\n");
 }
 
+/**
+ * Send the next queued character by polling
+ * Used while interrupts are disabled, when the TX interrupt cannot drain
+ */
+static void txPoll(void)
+{
+    if(TXIF && (txBuffer.rIndex != txBuffer.wIndex)){
+        TXREG = txBuffer.buffer[txBuffer.rIndex];
+        txBuffer.rIndex = (txBuffer.rIndex + 1) & (TX_BUFFER - 1);
+    }
+}
+
+void putRaw(uint8_t byte)
+{
+    uint8_t next = (txBuffer.wIndex + 1) & (TX_BUFFER - 1);
+    while(next == txBuffer.rIndex){
+        //Nothing drains the ring while auto-baud holds the TX interrupt
+        if((txPolicy == TX_DROP) || autoBaud){
+            ++uartErrors.txDrops;
+            return;
+        }
+        if(!INTCONbits.GIE){
+            txPoll();
+        }
+    }
+    txBuffer.buffer[txBuffer.wIndex] = byte;
+    txBuffer.wIndex = next;
+    //Held while auto-baud uses the baud generator
+    if(!autoBaud){
+        TXIE = 1;
+    }
+}
+
 /**
  * Putch for printf support
+ * Queues the character, the TX interrupt sends it. Text is dropped
+ * while the binary protocol is selected so it cannot break frames
  * @param byte
  */
 void putch(char byte)
 {
-	while(!TXIF) {
-		// Wait for transmit buffer to be ready
-	}
-	TXREG = byte;
+    if(protocol == PROTO_TEXT){
+        putRaw((uint8_t)byte);
+    }
 }
 
-void putShort(uint16_t v){
-    putch(v & 0xFF);
-    putch((v>>8) & 0xFF);
+void putString(const char* s)
+{
+    while(*s){
+        putch(*s++);
+    }
 }
 
-uint8_t getShort(uint16_t* v)
+void putHex8(uint8_t v)
 {
-    ms_t start = millis();
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
+    putch(HEX_DIGIT(v >> 4));
+    putch(HEX_DIGIT(v & 0xF));
+}
+
+void putHex16(uint16_t v)
+{
+    putHex8((uint8_t)(v >> 8));
+    putHex8((uint8_t)v);
+}
+
+//Powers of ten for the decimal output, no divide on this core
+static const uint32_t decimalPlaces[] = {
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL
+};
+
+void putUint(uint16_t v)
+{
+    //Same as putUlong, with 16-bit subtractions
+    bool digits = false;
+    for(uint8_t i=5;i<9;++i){
+        uint16_t place = (uint16_t)decimalPlaces[i];
+        char d = '0';
+        while(v >= place){
+            v -= place;
+            ++d;
+        }
+        if(digits || (d != '0')){
+            putch(d);
+            digits = true;
         }
     }
-    *v = rxBuffer.buffer[rxBuffer.uIndex];
-    if(++rxBuffer.uIndex == SER_BUFFER){
-        rxBuffer.uIndex = 0;
+    putch((char)('0' + v));
+}
+
+void putInt(int16_t v)
+{
+    if(v < 0){
+        putch('-');
+        putUint((uint16_t)-v);
+    }else{
+        putUint((uint16_t)v);
+    }
+}
+
+void putDec2(uint8_t v)
+{
+    char d = '0';
+    while(v >= 10){
+        v -= 10;
+        ++d;
     }
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
+    putch(d);
+    putch((char)('0' + v));
+}
+
+void putUlong(uint32_t v)
+{
+    //Leading zeros are skipped, the units are always sent
+    bool digits = false;
+    for(uint8_t i=0;i<9;++i){
+        char d = '0';
+        while(v >= decimalPlaces[i]){
+            v -= decimalPlaces[i];
+            ++d;
+        }
+        if(digits || (d != '0')){
+            putch(d);
+            digits = true;
         }
     }
-    *v |= (rxBuffer.buffer[rxBuffer.uIndex]<<8);
-    if(++rxBuffer.uIndex == SER_BUFFER){
-        rxBuffer.uIndex = 0;
+    putch((char)('0' + v));
+}
+
+void putShort(uint16_t v){
+    putch(v & 0xFF);
+    putch((v>>8) & 0xFF);
+}
+
+uint8_t rxSpan(const uint8_t** data)
+{
+    uint8_t end = rxBuffer.rIndex;
+    uint8_t start = rxBuffer.uIndex;
+    *data = (const uint8_t*)&rxBuffer.buffer[start];
+    if(end >= start){
+        return end - start;
     }
-    return 0;
+    //Wrapped, up to the end of the ring first
+    return SER_BUFFER - start;
 }
 
-uint8_t getByte(uint8_t* v)
+void rxConsume(uint8_t n)
 {
-    ms_t start = millis();
-    while(rxBuffer.rIndex == rxBuffer.uIndex){
-        if((millis()-start)>SERIAL_TIMEOUT){
-            //Timeout
-            return 1;
-        }
+    rxBuffer.uIndex = (rxBuffer.uIndex + n) & (SER_BUFFER - 1);
+    //Let the host send again once the ring drained
+    if(SER_INT && (rxCount() <= RX_RTS_LOW)){
+        SER_INT = 0;
     }
-    *v = rxBuffer.buffer[rxBuffer.uIndex];
-    if(++rxBuffer.uIndex == SER_BUFFER){
-       rxBuffer.uIndex = 0;
+}
+
+uint8_t rxCount(void)
+{
+    return (rxBuffer.rIndex - rxBuffer.uIndex) & (SER_BUFFER - 1);
+}
+
+void setFlowControl(bool enable)
+{
+    rxBuffer.rts = enable;
+    if(!enable){
+        SER_INT = 0;
     }
-    return 0;
 }
 
 bool byteAvail(void)
 {
     return rxBuffer.rIndex != rxBuffer.uIndex;
-}
\ No newline at end of file
+}
+
+void setTxPolicy(uint8_t policy)
+{
+    txPolicy = policy;
+}
+
+bool txPending(void)
+{
+    return txBuffer.rIndex != txBuffer.wIndex;
+}
+
+void serialFlush(void)
+{
+    while(txPending()){
+        if(!INTCONbits.GIE){
+            txPoll();
+        }
+    }
+    while(!TXSTAbits.TRMT){}
+}
+
+void setProtocol(uint8_t p)
+{
+    protocol = p;
+}
+
+uint8_t getProtocol(void)
+{
+    return protocol;
+}
+
+void setOutputMask(uint8_t mask)
+{
+    outputMask = mask;
+}
+
+bool outputEnabled(uint8_t cls)
+{
+    return (outputMask & cls) != 0;
+}
+
+uint16_t getBaudDivider(void)
+{
+    return baudDivider;
+}
+
+void startAutoBaud(void)
+{
+    serialFlush();
+    //The measuring character must not reach the receive buffer
+    RCIE = 0;
+    autoBaud = true;
+    timerStart(TIMER_BAUD, AUTOBAUD_TIMEOUT, false);
+    BAUDCTLbits.ABDEN = 1;
+}
+
+uint8_t serviceAutoBaud(void)
+{
+    uint8_t ret = BAUD_DONE;
+    if(!autoBaud){
+        return BAUD_IDLE;
+    }
+    if(BAUDCTLbits.ABDOVF || !timerRunning(TIMER_BAUD)){
+        //Too slow or nothing received, back to the previous rate
+        BAUDCTLbits.ABDEN = 0;
+        BAUDCTLbits.ABDOVF = 0;
+        BRG_WRITE(baudDivider);
+        ret = BAUD_FAILED;
+    }else if(BAUDCTLbits.ABDEN){
+        return BAUD_PENDING;
+    }else{
+        //Hardware cleared ABDEN, SPBRGH:SPBRG hold the measured divider
+        baudDivider = ((uint16_t)SPBRGH << 8) | SPBRG;
+    }
+    timerStop(TIMER_BAUD);
+    //Discard the measuring character
+    while(RCIF){
+        uint8_t dummy = RCREG;
+        (void)dummy;
+    }
+    autoBaud = false;
+    RCIE = 1;
+    if(txPending()){
+        TXIE = 1;
+    }
+    return ret;
+}
+
+bool autoBaudPending(void)
+{
+    return autoBaud;
+}
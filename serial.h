@@ -35,50 +35,266 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-// Baud rate: 9600 for improved reliability with crystal skew
-// Formula: DIVIDER = (_XTAL_FREQ / (16 * BAUD_RATE)) - 1
-// With _XTAL_FREQ=19600000: (19600000 / (16 * 9600)) - 1 = 126.7 ≈ 127
-// Actual baud: 9646 bps (0.48% error - well within UART specifications)
+// Baud rate, can be overridden at build time up to BAUD_MAX
+// 9600 by default for improved reliability with crystal skew
+#ifndef BAUD_RATE
 #define BAUD_RATE 9600
-#define DIVIDER ((int)(_XTAL_FREQ/(16UL * BAUD_RATE) -1))
+#endif
+#define BAUD_MAX 115200UL
+
+// 16-bit divider with BRG16 = 1 and BRGH = 1: baud = Fosc / (4 * (n + 1))
+// Rounded to the nearest rate. With _XTAL_FREQ=19600000 and 9600 baud:
+// (19600000 + 19200) / 38400 - 1 = 509, actual 9607 bps (0.07% error)
+#define BAUD_DIVIDER(fosc, baud) (((fosc) + 2UL*(baud)) / (4UL*(baud)) - 1)
+#define BAUD_ACTUAL(fosc, div) ((fosc) / (4UL * ((div) + 1UL)))
+// Rate error magnitude in 0.01% units
+#define BAUD_ERROR(fosc, baud) \
+    ((BAUD_ACTUAL(fosc, BAUD_DIVIDER(fosc, baud)) > (baud) ? \
+      BAUD_ACTUAL(fosc, BAUD_DIVIDER(fosc, baud)) - (baud) : \
+      (baud) - BAUD_ACTUAL(fosc, BAUD_DIVIDER(fosc, baud))) * 10000UL / (baud))
+// Largest usable error, both ends together must stay within about 4%
+#define BAUD_ERROR_MAX 200
+#define DIVIDER BAUD_DIVIDER(_XTAL_FREQ, BAUD_RATE)
+
+#if BAUD_RATE > BAUD_MAX
+#error "BAUD_RATE above BAUD_MAX"
+#endif
+#if defined(_XTAL_FREQ) && (BAUD_ERROR(_XTAL_FREQ, BAUD_RATE) > BAUD_ERROR_MAX)
+#error "No divider gives BAUD_RATE within 2% at _XTAL_FREQ"
+#endif
+
+// Write a 16-bit divider to SPBRGH:SPBRG
+#define BRG_WRITE(div) do{ SPBRGH = (uint8_t)((div) >> 8); SPBRG = (uint8_t)(div); }while(0)
+
+// Give up waiting for the auto-baud character after (ms)
+#define AUTOBAUD_TIMEOUT 10000
+// serviceAutoBaud() results
+#define BAUD_IDLE 0     // No detection running
+#define BAUD_PENDING 1  // Waiting for 0x55 from the host
+#define BAUD_DONE 2     // New divider in use
+#define BAUD_FAILED 3   // Timeout or overflow, previous divider restored
+
+// Default time to wait for the next byte of a command (ms)
+// Long enough for a host sending byte by byte or a USB adapter splitting packets
+#define SERIAL_TIMEOUT 250
 
 void initSerial(void);
 
+/**
+ * Print the startup banner, skipped while the binary protocol is selected
+ * Called once the configuration is applied
+ */
+void printBanner(void);
+
 void putch(char byte);
+
+/**
+ * Queue a byte for transmission whatever the protocol
+ * On a full ring the byte is dropped and counted in txDrops with TX_DROP
+ * or while auto-baud holds the TX interrupt, otherwise putRaw() waits
+ * @param byte Byte
+ */
+void putRaw(uint8_t byte);
 void putShort(uint16_t v);
 
-#define SER_BUFFER 16
+// Upper case hexadecimal digit of a nibble
+#define HEX_DIGIT(n) ((char)((n) < 10 ? '0' + (n) : 'A' - 10 + (n)))
+
+/**
+ * Lightweight replacements for printf on the hot paths
+ * They produce the same text as the printf conversion noted
+ */
+/**
+ * Send a string (%s)
+ * @param s Null terminated string, usually a literal in flash
+ */
+void putString(const char* s);
+
+/**
+ * Send a byte as 2 hexadecimal digits (%02X)
+ * @param v Value
+ */
+void putHex8(uint8_t v);
+
+/**
+ * Send a word as 4 hexadecimal digits (%04X)
+ * @param v Value
+ */
+void putHex16(uint16_t v);
+
+/**
+ * Send an unsigned decimal (%u)
+ * @param v Value
+ */
+void putUint(uint16_t v);
+
+/**
+ * Send a signed decimal (%d)
+ * @param v Value
+ */
+void putInt(int16_t v);
+
+/**
+ * Send a value below 100 as 2 digits (%02u)
+ * @param v Value
+ */
+void putDec2(uint8_t v);
+
+/**
+ * Send an unsigned long decimal (%lu)
+ * @param v Value
+ */
+void putUlong(uint32_t v);
+
+// Receive ring size, must be a power of 2
+#define SER_BUFFER 32
+// RTS flow control on SER_INT (RC5), low when the host may send
+// Raised at RX_RTS_HIGH bytes waiting, leaving room for the bytes the
+// host adapter sends before it reacts, lowered again at RX_RTS_LOW
+#define RX_RTS_HIGH (SER_BUFFER - 8)
+#define RX_RTS_LOW (SER_BUFFER / 4)
+// Transmit ring size, must be a power of 2
+#define TX_BUFFER 32
+
+// What putch does when the transmit ring is full
+#define TX_BLOCK 0      // Wait for the interrupt to make room
+#define TX_DROP 1       // Drop the character and count it in txDrops
+
+// Reply protocols
+#define PROTO_TEXT 0    // Verbose text lines (default)
+#define PROTO_BINARY 1  // SLIP framed messages only (see frame.h)
+
+// Output classes, muted classes are skipped before any formatting
+#define OUT_ECHO 0x01   // "RX:" echo of every received byte
+#define OUT_TRACE 0x02  // "CMD:" banner of every command
+#define OUT_CAT 0x04    // Cat detections and learn events
+#define OUT_STATUS 0x08 // Status replies, telemetry and schedule events
+#define OUT_ERROR 0x10  // Errors and warnings
+#define OUT_STATS 0x20  // Statistics replies
+#define OUT_ALL 0x3F
 
 // Error flags for UART monitoring
 struct UartErrors {
     uint8_t framingErrors;   // Count of framing errors
     uint8_t overrunErrors;   // Count of overrun errors  
     uint8_t bufferOverflows; // Count of ring buffer overflows
+    uint16_t txDrops;        // Count of characters dropped on a full transmit ring
 };
 extern volatile struct UartErrors uartErrors;
 
 struct RingBuffer{
-        uint8_t rIndex;
-        uint8_t uIndex;
+        uint8_t rIndex;     // Next free slot (ISR)
+        uint8_t uIndex;     // Next byte to use
+        bool rts;           // Drive SER_INT as RTS
         uint8_t buffer[SER_BUFFER];
 };
 extern volatile struct RingBuffer rxBuffer;
 
+// Transmit ring, filled by putch and drained by the TX interrupt
+struct TxBuffer{
+        uint8_t rIndex;     // Next character to send (ISR)
+        uint8_t wIndex;     // Next free slot (putch)
+        uint8_t buffer[TX_BUFFER];
+};
+extern volatile struct TxBuffer txBuffer;
+
 /**
- * Read a short
- * @param v Value read
- * @return 0 on success
+ * Set what putch does when the transmit ring is full
+ * @param policy TX_BLOCK or TX_DROP
  */
-uint8_t getShort(uint16_t* v);
+void setTxPolicy(uint8_t policy);
 
 /**
- * Read a byte, with timeout
- * @param v Value read
- * @return 0 on success
+ * Check if characters are waiting in the transmit ring
+ * @return true until the TX interrupt took the last one
  */
-uint8_t getByte(uint8_t* v);
+bool txPending(void);
+
+/**
+ * Wait until everything queued has left the UART shift register
+ */
+void serialFlush(void);
+
+/**
+ * Select the reply protocol
+ * putch output (printf, text emitters) is dropped in PROTO_BINARY
+ * @param p PROTO_TEXT or PROTO_BINARY
+ */
+void setProtocol(uint8_t p);
+
+/**
+ * Get the divider in use (DIVIDER unless auto-baud changed it)
+ * @return SPBRGH:SPBRG value at the crystal clock
+ */
+uint16_t getBaudDivider(void);
+
+/**
+ * Start measuring the host baud rate
+ * Waits for the queued output to leave, then the next character
+ * received must be 0x55 ('U') at the new rate. Nothing is sent or
+ * received until serviceAutoBaud() reports the end
+ */
+void startAutoBaud(void);
+
+/**
+ * Check the auto-baud detection, from the main loop
+ * @return BAUD_IDLE, BAUD_PENDING, BAUD_DONE or BAUD_FAILED
+ */
+uint8_t serviceAutoBaud(void);
+
+/**
+ * Check if auto-baud detection is running
+ * @return true until serviceAutoBaud() reported its end
+ */
+bool autoBaudPending(void);
+
+/**
+ * Get the reply protocol
+ * @return PROTO_TEXT or PROTO_BINARY
+ */
+uint8_t getProtocol(void);
+
+/**
+ * Select the output classes sent
+ * @param mask OUT_* bits
+ */
+void setOutputMask(uint8_t mask);
+
+/**
+ * Check an output class before formatting it
+ * @param cls OUT_* class
+ * @return false if the class is muted
+ */
+bool outputEnabled(uint8_t cls);
 
 bool byteAvail(void);
 
+/**
+ * Get the received bytes that are contiguous in the ring, without copying
+ * The bytes stay in the ring until rxConsume(). A second call after
+ * consuming returns the part that wrapped to the start of the ring
+ * @param data Set to the first byte
+ * @return Number of contiguous bytes, 0 if none
+ */
+uint8_t rxSpan(const uint8_t** data);
+
+/**
+ * Release bytes returned by rxSpan()
+ * @param n Number of bytes, at most the span length
+ */
+void rxConsume(uint8_t n);
+
+/**
+ * Get the number of received bytes waiting
+ * @return Count, at most SER_BUFFER - 1
+ */
+uint8_t rxCount(void);
+
+/**
+ * Enable RTS flow control on SER_INT
+ * @param enable false keeps SER_INT low
+ */
+void setFlowControl(bool enable);
+
 #endif	/* XC_HEADER_TEMPLATE_H */
 
@@ -5,6 +5,8 @@
 
 #include "xc_hardware_mock.h"
 #include <stdint.h>
+#include "interrupts.h"
+#include "peripherials.h"  // TMR1_PERIOD
 
 // Port registers
 uint8_t PORTA = 0;
@@ -30,6 +32,12 @@ uint8_t RCSTA = 0;
 uint8_t SPBRG = 0;
 uint8_t TXIF = 0;
 uint8_t RCIF = 0;
+uint8_t TXIE = 0;
+uint8_t RCIE = 0;
+uint8_t SPBRGH = 0;
+uint8_t BAUDCTL = 0;
+uint8_t TRISC6 = 1;
+uint8_t TRISC7 = 1;
 
 // EEPROM registers
 uint8_t EEADR = 0;
@@ -72,8 +80,16 @@ uint8_t PIR1 = 0;
 uint8_t PIR2 = 0;
 
 // Additional registers
+uint8_t CCP2IE = 0;
+uint8_t CCP2IF = 0;
 uint8_t CCP2CON = 0;
+uint8_t CCPR2H = 0;
+uint8_t CCPR2L = 0;
 uint8_t WPUB = 0;
+uint8_t IOCB = 0;
+
+// Power control registers
+uint8_t WDTCON = 0;
 
 // Bit-addressable structures
 OPTION_REG_bits_t OPTION_REGbits = {0};
@@ -83,14 +99,61 @@ PIE1_bits_t PIE1bits = {0};
 INTCON_bits_t INTCONbits = {0};
 ADCON0_bits_t ADCON0bits = {0};
 RCSTA_bits_t RCSTAbits = {0};
+TXSTA_bits_t TXSTAbits = {0};
+BAUDCTL_bits_t BAUDCTLbits = {0};
 T2CON_bits_t T2CONbits = {0};
 TRISC_bits_t TRISCbits = {0};
 PORTA_bits_t PORTAbits = {0};
 PORTB_bits_t PORTBbits = {0};
 PORTC_bits_t PORTCbits = {0};
+STATUS_bits_t STATUSbits = {0};
+OSCCON_bits_t OSCCONbits = {0};
+PIR2_bits_t PIR2bits = {0};
+PIE2_bits_t PIE2bits = {0};
 
 // Mock ADC result
 uint16_t mockADCResult = 0;
 
+// Mock data EEPROM
+uint8_t mockEeprom[256];
+uint16_t mockEepromWrites = 0;
+
+uint8_t eeprom_read(uint8_t addr)
+{
+    return mockEeprom[addr];
+}
+
+void eeprom_write(uint8_t addr, uint8_t value)
+{
+    mockEeprom[addr] = value;
+    ++mockEepromWrites;
+}
+
+void mockEepromErase(void)
+{
+    for (uint16_t i = 0; i < sizeof(mockEeprom); i++) {
+        mockEeprom[i] = 0xFF;
+    }
+    mockEepromWrites = 0;
+}
+
 // Mock millisecond counter
 uint32_t mockMillis = 0;
+
+// Timebase of interrupts.c, which needs the tick interrupt and is not built
+volatile uint16_t tmr1Period = TMR1_PERIOD;
+
+ms_t millis(void)
+{
+    return mockMillis;
+}
+
+uint32_t micros(void)
+{
+    return mockMillis * 1000UL;
+}
+
+void addMillis(ms_t ms)
+{
+    mockMillis += ms;
+}
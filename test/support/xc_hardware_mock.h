@@ -35,6 +35,10 @@
 // NOP operation
 #define NOP() 
 
+// Sleep and watchdog, the test sets STATUSbits to the wake-up it simulates
+#define SLEEP()
+#define CLRWDT()
+
 // Mock register definitions
 extern uint8_t PORTA;
 extern uint8_t PORTB;
@@ -57,6 +61,12 @@ extern uint8_t RCSTA;
 extern uint8_t SPBRG;
 extern uint8_t TXIF;
 extern uint8_t RCIF;
+extern uint8_t TXIE;
+extern uint8_t RCIE;
+extern uint8_t SPBRGH;
+extern uint8_t BAUDCTL;
+extern uint8_t TRISC6;
+extern uint8_t TRISC7;
 
 extern uint8_t EEADR;
 extern uint8_t EEDATA;
@@ -97,8 +107,16 @@ extern uint8_t PIR1;
 extern uint8_t PIR2;
 
 // Additional registers
+extern uint8_t CCP2IE;
+extern uint8_t CCP2IF;
 extern uint8_t CCP2CON;
+extern uint8_t CCPR2H;
+extern uint8_t CCPR2L;
 extern uint8_t WPUB;
+extern uint8_t IOCB;
+
+// Power control registers
+extern uint8_t WDTCON;
 
 // Bit-addressable structures for testing
 typedef struct {
@@ -185,6 +203,30 @@ typedef struct {
 } RCSTA_bits_t;
 extern RCSTA_bits_t RCSTAbits;
 
+typedef struct {
+    unsigned TX9D : 1;
+    unsigned TRMT : 1;
+    unsigned BRGH : 1;
+    unsigned SENDB : 1;
+    unsigned SYNC : 1;
+    unsigned TXEN : 1;
+    unsigned TX9 : 1;
+    unsigned CSRC : 1;
+} TXSTA_bits_t;
+extern TXSTA_bits_t TXSTAbits;
+
+typedef struct {
+    unsigned ABDEN : 1;
+    unsigned WUE : 1;
+    unsigned : 1;
+    unsigned BRG16 : 1;
+    unsigned SCKP : 1;
+    unsigned : 1;
+    unsigned RCIDL : 1;
+    unsigned ABDOVF : 1;
+} BAUDCTL_bits_t;
+extern BAUDCTL_bits_t BAUDCTLbits;
+
 typedef struct {
     unsigned TMR2ON : 1;
     unsigned T2CKPS0 : 1;
@@ -210,9 +252,9 @@ typedef struct {
 extern TRISC_bits_t TRISCbits;
 
 typedef struct {
-    unsigned RA0_bit : 1;
+    unsigned RA0 : 1;
     unsigned RA1 : 1;
-    unsigned RA2_bit : 1;
+    unsigned RA2 : 1;
     unsigned RA3 : 1;
     unsigned RA4 : 1;
     unsigned RA5 : 1;
@@ -222,7 +264,7 @@ typedef struct {
 extern PORTA_bits_t PORTAbits;
 
 typedef struct {
-    unsigned RB0_bit : 1;
+    unsigned RB0 : 1;
     unsigned RB1 : 1;
     unsigned RB2 : 1;
     unsigned RB3 : 1;
@@ -245,10 +287,64 @@ typedef struct {
 } PORTC_bits_t;
 extern PORTC_bits_t PORTCbits;
 
+typedef struct {
+    unsigned C : 1;
+    unsigned DC : 1;
+    unsigned Z : 1;
+    unsigned nPD : 1;
+    unsigned nTO : 1;
+    unsigned RP0 : 1;
+    unsigned RP1 : 1;
+    unsigned IRP : 1;
+} STATUS_bits_t;
+extern STATUS_bits_t STATUSbits;
+
+typedef struct {
+    unsigned SCS : 1;
+    unsigned LTS : 1;
+    unsigned HTS : 1;
+    unsigned OSTS : 1;
+    unsigned IRCF : 3;
+    unsigned : 1;
+} OSCCON_bits_t;
+extern OSCCON_bits_t OSCCONbits;
+
+typedef struct {
+    unsigned CCP2IF : 1;
+    unsigned : 1;
+    unsigned ULPWUIF : 1;
+    unsigned BCLIF : 1;
+    unsigned EEIF : 1;
+    unsigned C1IF : 1;
+    unsigned C2IF : 1;
+    unsigned OSFIF : 1;
+} PIR2_bits_t;
+extern PIR2_bits_t PIR2bits;
+
+typedef struct {
+    unsigned CCP2IE : 1;
+    unsigned : 1;
+    unsigned ULPWUIE : 1;
+    unsigned BCLIE : 1;
+    unsigned EEIE : 1;
+    unsigned C1IE : 1;
+    unsigned C2IE : 1;
+    unsigned OSFIE : 1;
+} PIE2_bits_t;
+extern PIE2_bits_t PIE2bits;
+
 // Mock ADC result for testing
 extern uint16_t mockADCResult;
 
-// Mock millisecond counter
+// Mock data EEPROM (256 bytes on the PIC16F886), erased to 0xFF
+extern uint8_t mockEeprom[256];
+// Number of eeprom_write() calls
+extern uint16_t mockEepromWrites;
+uint8_t eeprom_read(uint8_t addr);
+void eeprom_write(uint8_t addr, uint8_t value);
+void mockEepromErase(void);
+
+// Mock millisecond counter, returned by millis() in place of interrupts.c
 extern uint32_t mockMillis;
 
 #endif /* XC_HARDWARE_MOCK_H */
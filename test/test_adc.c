@@ -0,0 +1,116 @@
+/**
+ * Unit Tests for ADC Module
+ * 
+ * Tests the conversion clock, the channel selection and the background
+ * conversion handshake with the interrupt
+ * Note: Conversion timing is tested via hardware/integration tests
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before adc.h
+#include "adc.h"
+
+// Test fixtures
+void setUp(void)
+{
+    // This is run before each test
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Conversion clock is the fastest giving TAD >= 1.6us
+ */
+void test_adc_conversion_clock(void)
+{
+    // 19.6 MHz crystal needs Fosc/32
+    TEST_ASSERT_EQUAL(0x2, ADC_ADCS);
+    
+    // TAD = 32 / Fosc, in ns
+    uint32_t tadNs = (uint32_t)(32ULL * 1000000000ULL / _XTAL_FREQ);
+    TEST_ASSERT_TRUE(tadNs >= 1600);
+    
+    // Fosc/8 would be too fast
+    TEST_ASSERT_TRUE((uint32_t)(8ULL * 1000000000ULL / _XTAL_FREQ) < 1600);
+}
+
+/**
+ * Finish the background conversion as the ADC interrupt does
+ */
+static void conversionDone(uint16_t result)
+{
+    ADCON0bits.GO_DONE = 0;
+    adc.result = result;
+    adc.ready = true;
+    adc.busy = false;
+}
+
+/**
+ * Test: The multiplexer is only switched when the channel changes
+ */
+void test_adc_channel_select(void)
+{
+    uint16_t value = 0;
+    
+    initADC();
+    TEST_ASSERT_EQUAL_HEX8(0x80, ADCON1);
+    TEST_ASSERT_EQUAL_HEX8(ADC_CON0(ADC_LIGHT), ADCON0);
+    
+    adcStart(ADC_RFID);
+    TEST_ASSERT_EQUAL_HEX8(ADC_CON0(ADC_RFID), ADCON0);
+    TEST_ASSERT_TRUE(adc.busy);
+    TEST_ASSERT_EQUAL(1, ADCON0bits.GO_DONE);
+    TEST_ASSERT_EQUAL(1, PIE1bits.ADIE);
+    TEST_ASSERT_FALSE(adcResult(&value));
+    conversionDone(0x234);
+    
+    // Same channel, the hold capacitor stays connected
+    ADCON0 = 0;
+    adcStart(ADC_RFID);
+    TEST_ASSERT_EQUAL_HEX8(0, ADCON0);
+    conversionDone(0x123);
+}
+
+/**
+ * Test: A background result is read once
+ */
+void test_adc_result(void)
+{
+    uint16_t value = 0;
+    
+    initADC();
+    adcStart(ADC_LIGHT);
+    conversionDone(0x3FF);
+    TEST_ASSERT_TRUE(adcResult(&value));
+    TEST_ASSERT_EQUAL_HEX16(0x3FF, value);
+    TEST_ASSERT_FALSE(adcResult(&value));
+}
+
+/**
+ * Test: Acquisition delays
+ */
+void test_adc_acquisition_delays(void)
+{
+    // PIC16F886 datasheet requires 20µs minimum after a channel change
+    TEST_ASSERT_EQUAL(20, ADC_ACQUISITION_DELAY_US);
+    
+    // 2 TAD between conversions on the same channel
+    TEST_ASSERT_TRUE(ADC_REPEAT_DELAY_US * 1000UL >= 2 * (32ULL * 1000000000ULL / _XTAL_FREQ));
+    TEST_ASSERT_TRUE(ADC_REPEAT_DELAY_US < ADC_ACQUISITION_DELAY_US);
+}
+
+/**
+ * Test: The first conversion selects its channel, even AN0
+ */
+void test_adc_no_channel(void)
+{
+    // State at boot, before initADC()
+    adc.channel = ADC_NONE;
+    ADCON0 = 0;
+    adcStart(ADC_LIGHT);
+    TEST_ASSERT_EQUAL_HEX8(ADC_CON0(ADC_LIGHT), ADCON0);
+    conversionDone(0);
+}
@@ -10,7 +10,10 @@
 #include "unity.h"
 #include "xc_hardware_mock.h"
 #include "cat.h"
+#include "peripherials.h"  // Used by cat.c
+#include "adc.h"           // Used by peripherials.c
 #include "serial.h"
+#include "timer.h"     // Used by serial.c
 #include <string.h>
 
 // Test fixtures
@@ -4,13 +4,17 @@
  * Tests the functionality of storing and retrieving cat RFID tags
  * in EEPROM memory.
  * 
- * Note: Functions requiring EEPROM hardware (getCat, saveCat, etc.)
- * are tested via hardware/integration tests.
+ * Note: Configuration words are stored in the EEPROM mock, the other
+ * EEPROM functions (getCat, saveCat, etc.) are tested via
+ * hardware/integration tests.
  */
 
 #include "unity.h"
 #include "xc_hardware_mock.h"  // Must be included before cat.h
 #include "cat.h"
+#include "peripherials.h"  // Used by cat.c
+#include "adc.h"           // Used by peripherials.c
+#include "timer.h"         // Used by peripherials.c
 #include <string.h>
 
 // Test fixtures
@@ -54,18 +58,27 @@ void test_cat_slots_definition(void)
 }
 
 /**
- * Test: Configuration offsets
+ * Test: Configuration words are stored LSB first below the cat slots
  */
 void test_configuration_offsets(void)
 {
-    // Light threshold at offset 0
-    TEST_ASSERT_EQUAL(0, LIGHT_CFG);
-    
-#ifdef FLAP_POT
-    // Flap position configuration
-    TEST_ASSERT_EQUAL(1, FLAP_POS_IDLE);
-    TEST_ASSERT_EQUAL(2, FLAP_POS_MARGIN);
-#endif
+    mockEepromErase();
+    setConfiguration(LIGHT_CFG, 0x0203);
+    TEST_ASSERT_EQUAL_HEX8(0x03, mockEeprom[LIGHT_CFG*2]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, mockEeprom[LIGHT_CFG*2 + 1]);
+    TEST_ASSERT_EQUAL_HEX16(0x0203, getConfiguration(LIGHT_CFG));
+    
+    // Last word of the configuration area, right before the first slot
+    setConfiguration(CFG_WORDS - 1, 0x0405);
+    TEST_ASSERT_EQUAL_HEX8(0x04, mockEeprom[CAT_OFFSET - 1]);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mockEeprom[CAT_OFFSET]);
+    
+    // Past the area nothing is written, an unchanged value is not rewritten
+    uint16_t writes = mockEepromWrites;
+    setConfiguration(CFG_WORDS, 0);
+    setConfiguration(LIGHT_CFG, 0x0203);
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, mockEeprom[CAT_OFFSET]);
 }
 
 /**
@@ -0,0 +1,192 @@
+/**
+ * Unit Tests for Command Module
+ *
+ * Tests the parameter count of each command and the parser splitting the
+ * received bytes into plain, sequenced and batch commands
+ * Note: Running the commands is tested via hardware/integration tests
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before command.h
+#include "command.h"
+#include "timer.h"
+#include "config.h"    // Used by command.c
+#include "cat.h"       // Used by config.c
+#include "peripherials.h"  // Used by cat.c
+#include "adc.h"       // Used by peripherials.c
+#include "serial.h"    // Used by config.c
+#include "light.h"     // Used by config.c
+
+// Test fixtures
+void setUp(void)
+{
+    mockEepromErase();
+    initConfig();
+    cmdParser.state = CMD_STATE_IDLE;
+    timerStop(TIMER_SERIAL);
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Feed bytes to the parser
+ * @return Flags returned for the last byte
+ */
+static uint8_t parse(const uint8_t* bytes, uint8_t n)
+{
+    uint8_t parsed = 0;
+    for(uint8_t i=0;i<n;++i){
+        parsed = parseByte(bytes[i]);
+    }
+    return parsed;
+}
+
+/**
+ * Test: Known commands have a name
+ */
+void test_command_names(void)
+{
+    const char* known = "STLOKCGMBP";
+    while(*known){
+        TEST_ASSERT_NOT_NULL(commandName((uint8_t)*known++));
+    }
+    TEST_ASSERT_NULL(commandName('X'));
+    TEST_ASSERT_NULL(commandName('s'));
+    TEST_ASSERT_NULL(commandName(CMD_SEQ));
+}
+
+/**
+ * Test: Parameter count grows once the R/S selector is known
+ */
+void test_command_length(void)
+{
+    uint8_t read[] = {'R', 0};
+    uint8_t set[] = {'S', 0};
+
+    TEST_ASSERT_EQUAL_UINT8(0, commandLength('S', NULL, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, commandLength('M', NULL, 0));
+    TEST_ASSERT_EQUAL_UINT8(2, commandLength('P', NULL, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, commandLength('K', read, 0));
+    TEST_ASSERT_EQUAL_UINT8(1, commandLength('K', read, 1));
+    TEST_ASSERT_EQUAL_UINT8(5, commandLength('K', set, 1));
+    TEST_ASSERT_EQUAL_UINT8(2, commandLength('C', read, 1));
+    TEST_ASSERT_EQUAL_UINT8(4, commandLength('C', set, 1));
+    TEST_ASSERT_EQUAL_UINT8(3, commandLength('O', set, 1));
+}
+
+/**
+ * Test: A batch write grows with its count, a bad count ends it
+ */
+void test_command_length_batch(void)
+{
+    uint8_t args[] = {'S', 0};
+
+    TEST_ASSERT_EQUAL_UINT8(3, commandLength('G', NULL, 0));
+    TEST_ASSERT_EQUAL_UINT8(2, commandLength('G', args, 1));
+    TEST_ASSERT_EQUAL_UINT8(2, commandLength('G', args, 2));
+    args[1] = 1;
+    TEST_ASSERT_EQUAL_UINT8(5, commandLength('G', args, 2));
+    args[1] = CFG_BATCH;
+    TEST_ASSERT_EQUAL_UINT8(2 + CFG_BATCH*3, commandLength('G', args, 2));
+    args[1] = CFG_BATCH + 1;
+    TEST_ASSERT_EQUAL_UINT8(2, commandLength('G', args, 2));
+}
+
+/**
+ * Test: A command without parameters is ready at once
+ */
+void test_parse_plain(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND | PARSE_READY, parseByte('S'));
+    TEST_ASSERT_EQUAL_UINT8('S', cmdParser.cmd);
+    TEST_ASSERT_FALSE(cmdParser.tagged);
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_IDLE, cmdParser.state);
+    TEST_ASSERT_FALSE(timerRunning(TIMER_SERIAL));
+}
+
+/**
+ * Test: Parameters are collected one byte at a time
+ */
+void test_parse_args(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND, parseByte('C'));
+    TEST_ASSERT_EQUAL_HEX8(0, parseByte('S'));
+    TEST_ASSERT_EQUAL_HEX8(0, parseByte(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_HEX8(0, parseByte(0x2C));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_ARGS, cmdParser.state);
+    TEST_ASSERT_EQUAL_UINT8(3, cmdParser.len);
+
+    // Each byte restarts the timeout
+    TEST_ASSERT_TRUE(timerRunning(TIMER_SERIAL));
+    tickTimers(configValue(SERIAL_TIMEOUT_CFG) - 1);
+    TEST_ASSERT_EQUAL_HEX8(PARSE_READY, parseByte(0x01));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_IDLE, cmdParser.state);
+    const uint8_t args[] = {'S', LATCH_PULSE_CFG, 0x2C, 0x01};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(args, cmdParser.args, sizeof(args));
+}
+
+/**
+ * Test: Unknown commands are dropped, the next command is parsed
+ */
+void test_parse_unknown(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND | PARSE_UNKNOWN, parseByte('X'));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_IDLE, cmdParser.state);
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND, parseByte('M'));
+    TEST_ASSERT_EQUAL_HEX8(PARSE_READY, parseByte(2));
+    TEST_ASSERT_EQUAL_UINT8('M', cmdParser.cmd);
+    TEST_ASSERT_EQUAL_UINT8(2, cmdParser.args[0]);
+}
+
+/**
+ * Test: '#' and a sequence number tag the next command
+ */
+void test_parse_tagged(void)
+{
+    const uint8_t bytes[] = {CMD_SEQ, 'S', 'M', 3};
+
+    TEST_ASSERT_EQUAL_HEX8(0, parseByte(bytes[0]));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_SEQ, cmdParser.state);
+    // The sequence number may be any byte, even a command
+    TEST_ASSERT_EQUAL_HEX8(0, parseByte(bytes[1]));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_TAGGED, cmdParser.state);
+    TEST_ASSERT_EQUAL_HEX8(PARSE_READY, parse(&bytes[2], 2));
+    TEST_ASSERT_TRUE(cmdParser.tagged);
+    TEST_ASSERT_EQUAL_UINT8('S', cmdParser.seq);
+    TEST_ASSERT_EQUAL_UINT8('M', cmdParser.cmd);
+    TEST_ASSERT_EQUAL_UINT8(3, cmdParser.args[0]);
+
+    // The tag is for one command only
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND | PARSE_READY, parseByte('T'));
+    TEST_ASSERT_FALSE(cmdParser.tagged);
+}
+
+/**
+ * Test: Batch entries are collected apart from the parameters
+ */
+void test_parse_batch(void)
+{
+    const uint8_t bytes[] = {'G', 'S', 2,
+                             LATCH_PULSE_CFG, 0x2C, 0x01,
+                             OPEN_TIME_CFG, 0x10, 0x27};
+
+    TEST_ASSERT_EQUAL_HEX8(0, parse(bytes, sizeof(bytes) - 1));
+    TEST_ASSERT_EQUAL_HEX8(PARSE_READY, parseByte(bytes[sizeof(bytes) - 1]));
+    TEST_ASSERT_EQUAL_UINT8(2, cmdParser.args[1]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(&bytes[3], cmdBatch, 6);
+}
+
+/**
+ * Test: A batch count out of range ends the command after the count
+ */
+void test_parse_batch_count(void)
+{
+    const uint8_t bytes[] = {'G', 'S', CFG_BATCH + 1};
+
+    TEST_ASSERT_EQUAL_HEX8(PARSE_READY, parse(bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL_UINT8(CMD_STATE_IDLE, cmdParser.state);
+    TEST_ASSERT_EQUAL_HEX8(PARSE_COMMAND | PARSE_READY, parseByte('S'));
+}
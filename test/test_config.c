@@ -0,0 +1,192 @@
+/**
+ * Unit Tests for Config Module
+ * 
+ * Tests loading the settings from the EEPROM mock, the limits applied when
+ * storing them and the defaults the registry falls back to
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before config.h
+#include "config.h"
+#include "cat.h"           // Used by config.c
+#include "peripherials.h"
+#include "rfid.h"
+#include "adc.h"       // Used by rfid.c
+#include "serial.h"
+#include "timer.h"     // Used by serial.c
+#include "light.h"
+#include "power.h"
+
+// Test fixtures
+void setUp(void)
+{
+    mockEepromErase();
+    initConfig();
+}
+
+/**
+ * Store a setting as a previous firmware would have, bypassing the limits
+ */
+static void storeRaw(uint8_t index, uint16_t value)
+{
+    mockEeprom[index*2] = value & 0xFF;
+    mockEeprom[index*2 + 1] = value >> 8;
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Unprogrammed and out of range settings load their default
+ */
+void test_config_defaults(void)
+{
+    TEST_ASSERT_EQUAL_UINT16(LATCH_PULSE_TIME, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_UINT16(OPEN_TIME, configValue(OPEN_TIME_CFG));
+    TEST_ASSERT_EQUAL_INT16(0, (int16_t)configValue(RTC_DRIFT_CFG));
+
+    storeRaw(LATCH_PULSE_CFG, 10);
+    storeRaw(OPEN_TIME_CFG, 2000);
+    storeRaw(RTC_DRIFT_CFG, (uint16_t)-1001);
+    initConfig();
+    TEST_ASSERT_EQUAL_UINT16(LATCH_PULSE_TIME, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_UINT16(2000, configValue(OPEN_TIME_CFG));
+    TEST_ASSERT_EQUAL_INT16(0, (int16_t)configValue(RTC_DRIFT_CFG));
+}
+
+/**
+ * Test: Values within the limits are kept in RAM and EEPROM
+ */
+void test_config_set_value(void)
+{
+    TEST_ASSERT_TRUE(setConfigValue(LATCH_PULSE_CFG, 50));
+    TEST_ASSERT_EQUAL_UINT16(50, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_TRUE(setConfigValue(RTC_DRIFT_CFG, (uint16_t)-1000));
+    TEST_ASSERT_EQUAL_INT16(-1000, (int16_t)configValue(RTC_DRIFT_CFG));
+    TEST_ASSERT_TRUE(setConfigValue(IDLE_CFG, IDLE_SLEEP | IDLE_SLOW_CLOCK));
+
+    initConfig();
+    TEST_ASSERT_EQUAL_UINT16(50, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_INT16(-1000, (int16_t)getConfiguration(RTC_DRIFT_CFG));
+}
+
+/**
+ * Test: Values outside of the limits are refused and nothing is written
+ */
+void test_config_set_refused(void)
+{
+    uint16_t writes = mockEepromWrites;
+
+    TEST_ASSERT_FALSE(setConfigValue(LATCH_PULSE_CFG, 49));
+    TEST_ASSERT_FALSE(setConfigValue(LATCH_PULSE_CFG, 2001));
+    TEST_ASSERT_FALSE(setConfigValue(RTC_DRIFT_CFG, (uint16_t)-1001));
+    TEST_ASSERT_FALSE(setConfigValue(RTC_DRIFT_CFG, 1001));
+    // -1 would be stored as unprogrammed EEPROM
+    TEST_ASSERT_FALSE(setConfigValue(RTC_DRIFT_CFG, (uint16_t)-1));
+    // The idle policy is a bitmask
+    TEST_ASSERT_FALSE(setConfigValue(IDLE_CFG, (IDLE_SLEEP | IDLE_SLOW_CLOCK) + 1));
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+    TEST_ASSERT_EQUAL_UINT16(LATCH_PULSE_TIME, configValue(LATCH_PULSE_CFG));
+}
+
+/**
+ * Test: Only the configuration area can be written
+ */
+void test_config_set_index(void)
+{
+    uint16_t writes = mockEepromWrites;
+
+    //The cat slots follow the configuration area
+    TEST_ASSERT_FALSE(setConfigValue(CFG_WORDS, 0));
+    TEST_ASSERT_FALSE(setConfigValue(0xFF, 0));
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+
+    //Unregistered settings have no limits
+    TEST_ASSERT_TRUE(setConfigValue(SCHEDULE_CFG, 0x1234));
+    TEST_ASSERT_EQUAL_UINT16(0x1234, configValue(SCHEDULE_CFG));
+
+    uint16_t min, max;
+    TEST_ASSERT_FALSE(configLimits(SCHEDULE_CFG, &min, &max));
+    TEST_ASSERT_TRUE(configLimits(RTC_DRIFT_CFG, &min, &max));
+    TEST_ASSERT_EQUAL_INT16(-1000, (int16_t)min);
+    TEST_ASSERT_EQUAL_INT16(1000, (int16_t)max);
+}
+
+/**
+ * Test: Button gesture defaults keep the gestures apart
+ */
+void test_config_button_defaults(void)
+{
+    // A short red press (night) must end before a long one (vet)
+    TEST_ASSERT_TRUE(BTN_NIGHT_PRESS < BTN_VET_HOLD);
+    TEST_ASSERT_TRUE(BTN_VET_HOLD < BTN_LEARN_HOLD);
+    TEST_ASSERT_TRUE(BTN_LEARN_HOLD < BTN_CLEAR_HOLD);
+}
+
+/**
+ * Test: A batch is stored when every entry is valid
+ */
+void test_config_batch(void)
+{
+    uint8_t failed = 0xFF;
+    const uint8_t pairs[] = {
+        LATCH_PULSE_CFG, 0x2C, 0x01,            //300
+        RTC_DRIFT_CFG, 0x9C, 0xFF,              //-100
+        OPEN_TIME_CFG, 0x10, 0x27,              //10000
+    };
+
+    TEST_ASSERT_TRUE(setConfigValues(pairs, 3, &failed));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, failed);
+    TEST_ASSERT_EQUAL_UINT16(300, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_INT16(-100, (int16_t)configValue(RTC_DRIFT_CFG));
+    TEST_ASSERT_EQUAL_UINT16(10000, configValue(OPEN_TIME_CFG));
+
+    //Unchanged values are not written again
+    uint16_t writes = mockEepromWrites;
+    TEST_ASSERT_TRUE(setConfigValues(pairs, 3, &failed));
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+}
+
+/**
+ * Test: One refused entry leaves every setting unchanged
+ */
+void test_config_batch_refused(void)
+{
+    uint8_t failed = 0xFF;
+    const uint8_t pairs[] = {
+        LATCH_PULSE_CFG, 0x2C, 0x01,            //300
+        OPEN_TIME_CFG, 0x10, 0x27,              //10000
+        RTC_DRIFT_CFG, 0x17, 0xFC,              //-1001
+        CFG_WORDS, 0x00, 0x00,
+    };
+    uint16_t writes = mockEepromWrites;
+
+    TEST_ASSERT_FALSE(setConfigValues(pairs, 4, &failed));
+    TEST_ASSERT_EQUAL_UINT8(2, failed);
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+    TEST_ASSERT_EQUAL_UINT16(LATCH_PULSE_TIME, configValue(LATCH_PULSE_CFG));
+    TEST_ASSERT_EQUAL_UINT16(OPEN_TIME, configValue(OPEN_TIME_CFG));
+
+    //Past the configuration area
+    TEST_ASSERT_FALSE(setConfigValues(&pairs[9], 1, &failed));
+    TEST_ASSERT_EQUAL_UINT8(0, failed);
+    TEST_ASSERT_EQUAL_UINT16(writes, mockEepromWrites);
+}
+
+/**
+ * Test: Timing defaults
+ */
+void test_config_timing_defaults(void)
+{
+    // The latch must be fully moved before the relock can start
+    TEST_ASSERT_TRUE(LATCH_PULSE_TIME < OPEN_TIME);
+    TEST_ASSERT_TRUE(RELOCK_DELAY < OPEN_TIME);
+    TEST_ASSERT_TRUE(SERIAL_TIMEOUT > 0);
+    TEST_ASSERT_TRUE(LIGHT_READ_PERIOD > 0);
+    
+    // Carrier detection is below the bit decision level
+    TEST_ASSERT_TRUE(RFID_CARRIER_THRESHOLD < RFID_ADC_THRESHOLD);
+    TEST_ASSERT_TRUE(RFID_ADC_THRESHOLD <= 1023);
+}
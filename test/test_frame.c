@@ -0,0 +1,166 @@
+/**
+ * Unit Tests for Frame Module
+ * 
+ * Tests the SLIP characters and message identifiers of the binary protocol,
+ * the CRC and the frames queued on the serial transmit ring
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before frame.h
+#include "frame.h"
+#include "serial.h"
+#include "timer.h"     // Used by serial.c
+
+// Test fixtures
+void setUp(void)
+{
+    txBuffer.rIndex = 0;
+    txBuffer.wIndex = 0;
+}
+
+//Bytes queued since the last call
+static uint8_t sentBytes[TX_BUFFER];
+
+static uint8_t sent(void)
+{
+    uint8_t n = 0;
+    while(txBuffer.rIndex != txBuffer.wIndex){
+        sentBytes[n++] = txBuffer.buffer[txBuffer.rIndex];
+        txBuffer.rIndex = (txBuffer.rIndex + 1) & (TX_BUFFER - 1);
+    }
+    return n;
+}
+
+static uint16_t crcOf(const uint8_t* data, uint8_t n)
+{
+    uint16_t crc = FRAME_CRC_INIT;
+    for(uint8_t i=0;i<n;++i){
+        crc = frameCrc(crc, data[i]);
+    }
+    return crc;
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: SLIP characters follow RFC 1055
+ */
+void test_slip_characters(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(0xC0, SLIP_END);
+    TEST_ASSERT_EQUAL_HEX8(0xDB, SLIP_ESC);
+    TEST_ASSERT_EQUAL_HEX8(0xDC, SLIP_ESC_END);
+    TEST_ASSERT_EQUAL_HEX8(0xDD, SLIP_ESC_ESC);
+}
+
+/**
+ * Test: Message types are distinct and never need escaping
+ */
+void test_frame_types(void)
+{
+    uint8_t types[] = {FRAME_STATUS, FRAME_CAT, FRAME_CONFIG, FRAME_STATS,
+                       FRAME_MODE, FRAME_OCCUPANCY, FRAME_CLOCK, FRAME_LEARN,
+                       FRAME_BAUD, FRAME_TELEMETRY, FRAME_ACK, FRAME_DONE,
+                       FRAME_CONFIGS, FRAME_LEARN_EVENT, FRAME_SCHEDULE,
+                       FRAME_ERROR};
+    for(uint8_t i=0;i<sizeof(types);++i){
+        TEST_ASSERT_NOT_EQUAL(SLIP_END, types[i]);
+        TEST_ASSERT_NOT_EQUAL(SLIP_ESC, types[i]);
+        for(uint8_t j=i+1;j<sizeof(types);++j){
+            TEST_ASSERT_NOT_EQUAL(types[i], types[j]);
+        }
+    }
+}
+
+/**
+ * Test: Telemetry fields fit the field byte
+ */
+void test_telemetry_fields(void)
+{
+    TEST_ASSERT_EQUAL_HEX8(TLM_ALL, TLM_MODE | TLM_STATUS | TLM_NIGHT |
+                                    TLM_HOME | TLM_LIGHT | TLM_POLL);
+    TEST_ASSERT_EQUAL_HEX8(0, TLM_EVENTS & (TLM_LIGHT | TLM_POLL));
+}
+
+/**
+ * Test: Protocol selection values
+ */
+void test_frame_protocols(void)
+{
+    // Text stays the default (0 is also the registry default)
+    TEST_ASSERT_EQUAL(0, PROTO_TEXT);
+    TEST_ASSERT_NOT_EQUAL(PROTO_TEXT, PROTO_BINARY);
+}
+
+/**
+ * Test: CRC-16/CCITT-FALSE check value
+ */
+void test_frame_crc(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crcOf((const uint8_t*)"123456789", 9));
+    TEST_ASSERT_EQUAL_HEX16(FRAME_CRC_INIT, crcOf(NULL, 0));
+}
+
+/**
+ * Test: A frame is END, type, seq, payload, CRC LSB first, END
+ */
+void test_frame_layout(void)
+{
+    frameBegin(FRAME_MODE);
+    framePut(2);
+    frameEnd();
+    TEST_ASSERT_EQUAL_UINT8(7, sent());
+    TEST_ASSERT_EQUAL_HEX8(SLIP_END, sentBytes[0]);
+    TEST_ASSERT_EQUAL_HEX8(FRAME_MODE, sentBytes[1]);
+    TEST_ASSERT_EQUAL_HEX8(2, sentBytes[3]);
+    uint16_t crc = crcOf(&sentBytes[1], 3);
+    TEST_ASSERT_EQUAL_HEX8(crc & 0xFF, sentBytes[4]);
+    TEST_ASSERT_EQUAL_HEX8(crc >> 8, sentBytes[5]);
+    TEST_ASSERT_EQUAL_HEX8(SLIP_END, sentBytes[6]);
+
+    // The sequence number counts the frames
+    uint8_t seq = sentBytes[2];
+    frameBegin(FRAME_ACK);
+    TEST_ASSERT_EQUAL_UINT8(3, sent());
+    TEST_ASSERT_EQUAL_HEX8((uint8_t)(seq + 1), sentBytes[2]);
+    frameEnd();
+    sent();
+}
+
+/**
+ * Test: Multi-byte fields are LSB first, END and ESC are escaped and the
+ * CRC covers the unescaped bytes
+ */
+void test_frame_escape(void)
+{
+    frameBegin(FRAME_CLOCK);
+    TEST_ASSERT_EQUAL_UINT8(3, sent());
+    uint8_t seq = sentBytes[2];
+    framePutShort(0xDBC0);
+    framePutLong(0x12345678UL);
+    frameEnd();
+    uint8_t n = sent();
+    const uint8_t escaped[] = {SLIP_ESC, SLIP_ESC_END, SLIP_ESC, SLIP_ESC_ESC,
+                               0x78, 0x56, 0x34, 0x12};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(escaped, sentBytes, sizeof(escaped));
+
+    const uint8_t raw[] = {FRAME_CLOCK, seq, 0xC0, 0xDB, 0x78, 0x56, 0x34, 0x12};
+    uint16_t crc = crcOf(raw, sizeof(raw));
+    TEST_ASSERT_TRUE(n >= sizeof(escaped) + 3);
+    TEST_ASSERT_EQUAL_HEX8(SLIP_END, sentBytes[n-1]);
+    //Rebuild the CRC field, it may be escaped as well
+    uint8_t crcBytes[2];
+    uint8_t j = 0;
+    for(uint8_t i=sizeof(escaped);i<n-1;++i){
+        uint8_t v = sentBytes[i];
+        if(v == SLIP_ESC){
+            v = (sentBytes[++i] == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+        }
+        crcBytes[j++] = v;
+    }
+    TEST_ASSERT_EQUAL_UINT8(2, j);
+    TEST_ASSERT_EQUAL_HEX16(crc, crcBytes[0] | ((uint16_t)crcBytes[1] << 8));
+}
@@ -0,0 +1,86 @@
+/**
+ * Unit Tests for Light Module
+ * 
+ * Tests the oversampling and filter definitions used by night mode
+ * Note: ADC reads are tested via hardware/integration tests
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before light.h
+#include "light.h"
+#include "adc.h"       // Used by light.c
+#include "timer.h"     // Used by light.c
+
+// Test fixtures
+void setUp(void)
+{
+    // This is run before each test
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Oversampled sum of full scale reads fits 16 bits
+ */
+void test_light_oversample_range(void)
+{
+    TEST_ASSERT_EQUAL(16, LIGHT_OVERSAMPLE);
+    TEST_ASSERT_TRUE((uint32_t)1023 * LIGHT_OVERSAMPLE <= 0xFFFF);
+    
+    // Highest threshold still fits once scaled
+    TEST_ASSERT_TRUE((uint32_t)1023 << LIGHT_OVERSAMPLE_SHIFT <= 0xFFFF);
+}
+
+/**
+ * Test: Filter keeps a steady light unchanged
+ */
+void test_light_ema_steady(void)
+{
+    uint32_t acc = (uint32_t)8000 << LIGHT_EMA_SHIFT;
+    
+    acc = LIGHT_EMA(acc, 8000);
+    
+    TEST_ASSERT_EQUAL_UINT32(8000, acc >> LIGHT_EMA_SHIFT);
+}
+
+/**
+ * Test: A single bright read only moves the filter by its weight
+ */
+void test_light_ema_spike(void)
+{
+    uint32_t acc = (uint32_t)8000 << LIGHT_EMA_SHIFT;
+    
+    // Headlights, sensor reads 0 (more is darker)
+    acc = LIGHT_EMA(acc, 0);
+    
+    TEST_ASSERT_EQUAL_UINT32(8000 - (8000 >> LIGHT_EMA_SHIFT), acc >> LIGHT_EMA_SHIFT);
+}
+
+/**
+ * Test: Filter converges to a new level
+ */
+void test_light_ema_converges(void)
+{
+    uint32_t acc = 0;
+    
+    for (int i = 0; i < 200; i++) {
+        acc = LIGHT_EMA(acc, 16000);
+    }
+    
+    TEST_ASSERT_UINT32_WITHIN(8, 16000, acc >> LIGHT_EMA_SHIFT);
+}
+
+/**
+ * Test: Default limits
+ */
+void test_light_defaults(void)
+{
+    // Same hysteresis as the previous fixed value
+    TEST_ASSERT_EQUAL(5, LIGHT_HYSTERESIS);
+    
+    // Dwell covers several filter time constants
+    TEST_ASSERT_TRUE((uint32_t)LIGHT_DWELL * 1000 > ((uint32_t)LIGHT_READ_PERIOD << LIGHT_EMA_SHIFT));
+}
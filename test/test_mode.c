@@ -0,0 +1,174 @@
+/**
+ * Unit Tests for Mode Module
+ * 
+ * Tests the operating mode numbering, the locks and LEDs of the mode
+ * table, the learn window and the transient clear mode
+ * Note: Latch pulses are tested via hardware/integration tests
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before mode.h
+#include "mode.h"
+#include "timer.h"
+#include "cat.h"
+#include "serial.h"
+#include "peripherials.h"  // Used by mode.c
+#include "light.h"     // Used by mode.c
+#include "frame.h"     // Used by mode.c
+#include "adc.h"       // Used by light.c
+#include "config.h"    // Used by cat.c
+
+// Test fixtures
+void setUp(void)
+{
+    mockEepromErase();
+    initOccupancy();
+    //Learn events must not wait on the transmit ring
+    setTxPolicy(TX_DROP);
+    switchMode(MODE_NORMAL);
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Mode numbers used by the 'M' command and the schedule
+ */
+void test_mode_numbers(void)
+{
+    TEST_ASSERT_EQUAL(0, MODE_NORMAL);
+    TEST_ASSERT_EQUAL(1, MODE_VET);
+    TEST_ASSERT_EQUAL(2, MODE_CLOSED);
+    TEST_ASSERT_EQUAL(3, MODE_NIGHT);
+    TEST_ASSERT_EQUAL(4, MODE_LEARN);
+    TEST_ASSERT_EQUAL(5, MODE_CLEAR);
+    TEST_ASSERT_EQUAL(6, MODE_OPEN);
+    TEST_ASSERT_EQUAL(MODE_OPEN + 1, MODE_COUNT);
+}
+
+/**
+ * Test: Flags and lock bits are separate bits
+ */
+void test_mode_flags(void)
+{
+    uint8_t flags[] = {MODE_RFID, MODE_LIGHT, MODE_FAST_POLL, MODE_TRANSIENT};
+    uint8_t all = 0;
+    
+    for (size_t i = 0; i < sizeof(flags); i++) {
+        TEST_ASSERT_EQUAL(0, all & flags[i]);
+        all |= flags[i];
+    }
+    TEST_ASSERT_EQUAL(0, LOCK_IN & LOCK_OUT);
+}
+
+/**
+ * Test: LED patterns are distinct
+ */
+void test_mode_led_patterns(void)
+{
+    TEST_ASSERT_EQUAL(0, LED_OFF);
+    TEST_ASSERT_NOT_EQUAL(LED_ON, LED_BLINK);
+    TEST_ASSERT_NOT_EQUAL(LED_BLINK, LED_BLINK_FAST);
+    TEST_ASSERT_NOT_EQUAL(LED_BLINK_FAST, LED_OUT_LOCKED);
+}
+
+/**
+ * Test: Each mode asks for its locks
+ */
+void test_mode_locks(void)
+{
+    switchMode(MODE_NORMAL);
+    TEST_ASSERT_TRUE(isInLocked());
+    TEST_ASSERT_FALSE(isOutLocked());
+    switchMode(MODE_VET);
+    TEST_ASSERT_TRUE(isInLocked());
+    TEST_ASSERT_TRUE(isOutLocked());
+    switchMode(MODE_OPEN);
+    TEST_ASSERT_FALSE(isInLocked());
+    TEST_ASSERT_FALSE(isOutLocked());
+    TEST_ASSERT_EQUAL(MODE_OPEN, getMode());
+}
+
+/**
+ * Test: Unknown modes select the normal mode
+ */
+void test_mode_unknown(void)
+{
+    switchMode(MODE_OPEN);
+    switchMode(MODE_COUNT);
+    TEST_ASSERT_EQUAL(MODE_NORMAL, getMode());
+    TEST_ASSERT_TRUE(isInLocked());
+}
+
+/**
+ * Test: runMode drives the LED patterns and returns the mode flags
+ */
+void test_mode_leds(void)
+{
+    switchMode(MODE_OPEN);
+    TEST_ASSERT_EQUAL(0, runMode(0));
+    TEST_ASSERT_TRUE(GREEN_LED);
+    TEST_ASSERT_TRUE(RED_LED);
+
+    //Slow blink: 512ms off, 512ms on
+    switchMode(MODE_VET);
+    TEST_ASSERT_EQUAL(MODE_RFID, runMode(511));
+    TEST_ASSERT_FALSE(GREEN_LED);
+    TEST_ASSERT_FALSE(RED_LED);
+    runMode(512);
+    TEST_ASSERT_FALSE(GREEN_LED);
+    TEST_ASSERT_TRUE(RED_LED);
+
+    //Fast blink: 256ms off, 256ms on
+    switchMode(MODE_LEARN);
+    TEST_ASSERT_EQUAL(MODE_RFID | MODE_FAST_POLL, runMode(255));
+    TEST_ASSERT_FALSE(GREEN_LED);
+    runMode(256);
+    TEST_ASSERT_TRUE(GREEN_LED);
+    TEST_ASSERT_FALSE(RED_LED);
+}
+
+/**
+ * Test: Learn mode waits LEARN_TIME for a new cat
+ */
+void test_mode_learn_time(void)
+{
+    switchMode(MODE_LEARN);
+    TEST_ASSERT_TRUE(timerRunning(TIMER_LEARN));
+    tickTimers(LEARN_TIME - 1);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_LEARN));
+    tickTimers(1);
+    TEST_ASSERT_TRUE(timerExpired(TIMER_LEARN));
+}
+
+/**
+ * Test: Leaving learn mode stops the window
+ */
+void test_mode_learn_exit(void)
+{
+    switchMode(MODE_LEARN);
+    switchMode(MODE_NORMAL);
+    TEST_ASSERT_FALSE(timerRunning(TIMER_LEARN));
+    tickTimers(LEARN_TIME);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_LEARN));
+}
+
+/**
+ * Test: Clear mode forgets the cats and chains to the normal mode
+ */
+void test_mode_clear(void)
+{
+    Cat cat = {0x1234, {1, 2, 3, 4, 5, 6}};
+
+    clearCats();
+    TEST_ASSERT_NOT_EQUAL(0, saveCat(&cat));
+    TEST_ASSERT_NOT_EQUAL(0, getStoredCats());
+    switchMode(MODE_OPEN);
+    switchMode(MODE_CLEAR);
+    TEST_ASSERT_EQUAL(0, getStoredCats());
+    TEST_ASSERT_EQUAL(MODE_NORMAL, getMode());
+    TEST_ASSERT_TRUE(isInLocked());
+    TEST_ASSERT_FALSE(isOutLocked());
+}
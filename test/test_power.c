@@ -0,0 +1,277 @@
+/**
+ * Unit Tests for Power Module
+ * 
+ * Tests the idle sleep and slow clock definitions, and the time accounted
+ * for each kind of wake-up against the register mock
+ * Note: Real sleep current and wake-up latency are tested on hardware
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before power.h
+#include "power.h"
+#include "serial.h"      // Used by power.c
+#include "timer.h"       // Used by serial.c
+#include "peripherials.h"  // Used by power.c
+#include "adc.h"           // Used by power.c
+
+// Test fixtures
+void setUp(void)
+{
+    // This is run before each test
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Watchdog period follows the 31 kHz LFINTOSC prescaler
+ */
+void test_idle_wdt_period(void)
+{
+    // 1:32 prescaler is about 1ms
+    TEST_ASSERT_EQUAL_UINT32(1, IDLE_WDT_MS(0));
+    // 1:512 prescaler is about 16ms
+    TEST_ASSERT_EQUAL_UINT32(16, IDLE_WDT_MS(4));
+    // 1:4096 prescaler is about 132ms
+    TEST_ASSERT_EQUAL_UINT32(132, IDLE_WDT_MS(7));
+}
+
+/**
+ * Test: Poll sleep is not longer than the 20ms RFID relax delay
+ */
+void test_idle_poll_shorter_than_relax(void)
+{
+    TEST_ASSERT_TRUE(IDLE_WDT_MS(IDLE_POLL) <= 20);
+    TEST_ASSERT_TRUE(IDLE_WDT_MS(IDLE_LONG) > IDLE_WDT_MS(IDLE_POLL));
+}
+
+/**
+ * Prepare an idle core: no traffic, nothing pending, awake hold elapsed
+ */
+static void idleState(void)
+{
+    mockMillis += IDLE_AWAKE_MS;
+    TXSTAbits.TRMT = 1;
+    BAUDCTLbits.RCIDL = 1;
+    BAUDCTLbits.WUE = 0;
+    setIdlePolicy(IDLE_SLEEP);
+}
+
+/**
+ * Test: A watchdog wake-up accounts a full period
+ */
+void test_idle_sleep_watchdog_wake(void)
+{
+    idleState();
+    ms_t slept = getSleepTime();
+    ms_t before = millis();
+    // Slept, then woken by the watchdog time-out
+    STATUSbits.nPD = 0;
+    STATUSbits.nTO = 0;
+    
+    TEST_ASSERT_TRUE(idleSleep(IDLE_LONG));
+    TEST_ASSERT_EQUAL_UINT32(IDLE_WDT_MS(IDLE_LONG), millis() - before);
+    TEST_ASSERT_EQUAL_UINT32(IDLE_WDT_MS(IDLE_LONG), getSleepTime() - slept);
+    TEST_ASSERT_EQUAL_UINT8(0, WDTCON);
+    TEST_ASSERT_EQUAL_UINT8(0, BAUDCTLbits.WUE);
+}
+
+/**
+ * Test: An early wake-up accounts half a period
+ */
+void test_idle_sleep_early_wake(void)
+{
+    idleState();
+    ms_t slept = getSleepTime();
+    ms_t before = millis();
+    // Slept, woken by the door, a button or the UART
+    STATUSbits.nPD = 0;
+    STATUSbits.nTO = 1;
+    
+    TEST_ASSERT_TRUE(idleSleep(IDLE_LONG));
+    TEST_ASSERT_EQUAL_UINT32(IDLE_WDT_MS(IDLE_LONG) / 2, millis() - before);
+    TEST_ASSERT_EQUAL_UINT32(IDLE_WDT_MS(IDLE_LONG) / 2, getSleepTime() - slept);
+}
+
+/**
+ * Test: A wake-up flag pending before SLEEP accounts no time
+ */
+void test_idle_sleep_skipped(void)
+{
+    idleState();
+    ms_t slept = getSleepTime();
+    ms_t before = millis();
+    // SLEEP executed as a NOP, power-down bit still set by CLRWDT
+    STATUSbits.nPD = 1;
+    STATUSbits.nTO = 1;
+    
+    TEST_ASSERT_TRUE(idleSleep(IDLE_POLL));
+    TEST_ASSERT_EQUAL_UINT32(before, millis());
+    TEST_ASSERT_EQUAL_UINT32(slept, getSleepTime());
+}
+
+/**
+ * Test: The core stays awake while busy and for the hold after traffic
+ */
+void test_idle_awake_hold(void)
+{
+    idleState();
+    STATUSbits.nPD = 1;
+    
+    // Latch pulse waiting to be sent
+    moveLatches(LATCH_RED, LATCH_RED);
+    TEST_ASSERT_FALSE(idleSleep(IDLE_POLL));
+    // Pulse running, then timed out
+    TEST_ASSERT_TRUE(serviceLatches());
+    TEST_ASSERT_FALSE(idleSleep(IDLE_POLL));
+    tickTimers(getLatchPulse());
+    TEST_ASSERT_FALSE(serviceLatches());
+    
+    // Receiver active restarts the awake hold
+    BAUDCTLbits.RCIDL = 0;
+    TEST_ASSERT_FALSE(idleSleep(IDLE_POLL));
+    BAUDCTLbits.RCIDL = 1;
+    mockMillis += IDLE_AWAKE_MS - 1;
+    TEST_ASSERT_FALSE(idleSleep(IDLE_POLL));
+    mockMillis += 1;
+    TEST_ASSERT_TRUE(idleSleep(IDLE_POLL));
+    
+    // Not allowed by the policy
+    setIdlePolicy(0);
+    TEST_ASSERT_FALSE(idleSleep(IDLE_POLL));
+}
+
+/**
+ * Test: UART divider at the internal oscillator
+ */
+void test_slow_uart_divider(void)
+{
+    // (4000000 + 19200) / 38400 - 1 = 103
+    TEST_ASSERT_EQUAL(103, DIVIDER_SLOW);
+    TEST_ASSERT_TRUE(SLOW_BAUD_OK);
+    
+    // Actual baud rate within 1% of nominal
+    uint32_t actual = BAUD_ACTUAL(CLOCK_SLOW_FREQ, DIVIDER_SLOW);
+    TEST_ASSERT_UINT_WITHIN(BAUD_RATE / 100, BAUD_RATE, actual);
+}
+
+/**
+ * Place Timer 1 and the tick compare
+ */
+static void setTick(uint16_t now, uint16_t compare)
+{
+    TMR1H = (uint8_t)(now >> 8);
+    TMR1L = (uint8_t)now;
+    CCPR2H = (uint8_t)(compare >> 8);
+    CCPR2L = (uint8_t)compare;
+}
+
+static uint16_t tickCompare(void)
+{
+    return ((uint16_t)CCPR2H << 8) | CCPR2L;
+}
+
+/**
+ * Time into the current tick, as micros() computes it
+ */
+static uint16_t tickMicros(void)
+{
+    uint16_t now = ((uint16_t)TMR1H << 8) | TMR1L;
+    uint16_t left = tickCompare() - now;
+    return (uint16_t)((uint32_t)(tmr1Period - left) * 1000UL / tmr1Period);
+}
+
+/**
+ * Prepare a core on the crystal, allowed to slow down
+ */
+static void clockState(void)
+{
+    TXSTAbits.TRMT = 1;
+    BAUDCTLbits.RCIDL = 1;
+    OSCCONbits.OSTS = 1;
+    CCP2IF = 0;
+    setIdlePolicy(0);
+    setIdlePolicy(IDLE_SLOW_CLOCK);
+}
+
+/**
+ * Test: A clock switch keeps the time already spent in the tick
+ */
+void test_clock_switch_mid_tick(void)
+{
+    clockState();
+    // 1000 of 1225 counts, 816us into the tick
+    setTick(1000, TMR1_PERIOD);
+    uint16_t us = tickMicros();
+    
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_SLOW_PERIOD, tmr1Period);
+    TEST_ASSERT_EQUAL_UINT8(OSCCONbits.IRCF, CLOCK_SLOW_IRCF);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)DIVIDER_SLOW, SPBRG);
+    TEST_ASSERT_UINT_WITHIN(4, us, tickMicros());
+    // The 225 counts left become 45 at the slow rate
+    TEST_ASSERT_EQUAL_UINT16(1045, tickCompare());
+    
+    // Half a tick at the slow rate, across the Timer 1 overflow
+    setTick(0xFFF0, (uint16_t)(0xFFF0 + TMR1_SLOW_PERIOD/2));
+    clockFast();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tmr1Period);
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)DIVIDER, SPBRG);
+    TEST_ASSERT_UINT_WITHIN(4, 500, tickMicros());
+    TEST_ASSERT_EQUAL_UINT16((uint16_t)(0xFFF0 + 612), tickCompare());
+}
+
+/**
+ * Test: A compare that already matched is left to the tick interrupt
+ */
+void test_clock_switch_tick_pending(void)
+{
+    clockState();
+    setTick(1300, TMR1_PERIOD);
+    CCP2IF = 1;
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_SLOW_PERIOD, tmr1Period);
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tickCompare());
+    CCP2IF = 0;
+    clockFast();
+}
+
+/**
+ * Test: The slow clock is refused while the UART rate is not the default
+ */
+void test_clock_slow_refused(void)
+{
+    clockState();
+    setTick(0, TMR1_PERIOD);
+    
+    // Auto-baud measures at the crystal rate
+    startAutoBaud();
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tmr1Period);
+    
+    // Host rate measured, the slow divider would not match it
+    SPBRGH = 0;
+    SPBRG = 50;
+    BAUDCTLbits.ABDEN = 0;
+    TEST_ASSERT_EQUAL_UINT8(BAUD_DONE, serviceAutoBaud());
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tmr1Period);
+    TEST_ASSERT_EQUAL_UINT8(50, SPBRG);
+    
+    // Back at the default rate
+    startAutoBaud();
+    SPBRGH = (uint8_t)(DIVIDER >> 8);
+    SPBRG = (uint8_t)DIVIDER;
+    BAUDCTLbits.ABDEN = 0;
+    TEST_ASSERT_EQUAL_UINT8(BAUD_DONE, serviceAutoBaud());
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_SLOW_PERIOD, tmr1Period);
+    
+    // Not allowed by the policy
+    setIdlePolicy(IDLE_SLEEP);
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tmr1Period);
+    clockSlow();
+    TEST_ASSERT_EQUAL_UINT16(TMR1_PERIOD, tmr1Period);
+}
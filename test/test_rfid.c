@@ -1,7 +1,8 @@
 /**
  * Unit Tests for RFID Module
  * 
- * Tests the RFID tag reading error codes and definitions
+ * Tests the RFID tag reading error codes and definitions, and the adaptive
+ * poll schedule driven by the mock millisecond counter
  * Note: Full RFID hardware functions require actual PIC16F886 hardware
  * and are tested via integration/hardware tests
  */
@@ -9,6 +10,8 @@
 #include "unity.h"
 #include "xc_hardware_mock.h"  // Must be included before rfid.h
 #include "rfid.h"
+#include "adc.h"       // Used by rfid.c
+#include "timer.h"     // Used by rfid.c
 
 // Test fixtures
 void setUp(void)
@@ -119,6 +122,108 @@ void test_error_code_priority(void)
     TEST_ASSERT_GREATER_THAN(BAD_START, BAD_CRC);     // 4 > 3
 }
 
+/**
+ * Start from recent activity with the default limits
+ */
+static void pollReset(void)
+{
+    mockMillis += 100000;
+    setPollLimits(RFID_POLL_MIN, RFID_POLL_MAX);
+    setPollQuiet(false);
+    pollActivity();
+    pollDue();
+}
+
+/**
+ * Let the hold time since the last activity elapse and poll
+ */
+static void idle(void)
+{
+    mockMillis += RFID_POLL_HOLD + 1;
+    TEST_ASSERT_TRUE(pollDue());
+}
+
+/**
+ * Wait for the next poll
+ * @return Interval scheduled after it
+ */
+static uint16_t nextPoll(void)
+{
+    mockMillis += getPollInterval() - 1;
+    TEST_ASSERT_FALSE(pollDue());
+    TEST_ASSERT_EQUAL_UINT32(1, pollWait());
+    mockMillis += 1;
+    TEST_ASSERT_TRUE(pollDue());
+    return getPollInterval();
+}
+
+/**
+ * Test: Fastest rate while active, doubling up to the limit once idle
+ */
+void test_rfid_poll_backoff(void)
+{
+    pollReset();
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MIN, getPollInterval());
+    
+    // Within the hold time the fastest rate is kept
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MIN, nextPoll());
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MIN, nextPoll());
+    
+    // Idle past the hold: 40, 80, 160, 320, then capped at 500
+    idle();
+    TEST_ASSERT_EQUAL_UINT16(40, getPollInterval());
+    TEST_ASSERT_EQUAL_UINT16(80, nextPoll());
+    TEST_ASSERT_EQUAL_UINT16(160, nextPoll());
+    TEST_ASSERT_EQUAL_UINT16(320, nextPoll());
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MAX, nextPoll());
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MAX, nextPoll());
+    
+    // Activity drops back to the fastest rate
+    pollActivity();
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MIN, getPollInterval());
+}
+
+/**
+ * Test: Slower limit while every cat is home, restored when one leaves
+ */
+void test_rfid_poll_quiet(void)
+{
+    pollReset();
+    setPollQuiet(true);
+    idle();
+    uint16_t interval = getPollInterval();
+    for(uint8_t i=0;(i<10) && (interval < RFID_POLL_QUIET);++i){
+        interval = nextPoll();
+    }
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_QUIET, interval);
+    
+    setPollQuiet(false);
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MAX, getPollInterval());
+}
+
+/**
+ * Test: Unprogrammed or inverted limits
+ */
+void test_rfid_poll_limit_settings(void)
+{
+    pollReset();
+    // Unprogrammed EEPROM selects the defaults
+    setPollLimits(0xFFFF, 0);
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MIN, getPollInterval());
+    idle();
+    for(uint8_t i=0;i<10;++i){
+        nextPoll();
+    }
+    TEST_ASSERT_EQUAL_UINT16(RFID_POLL_MAX, getPollInterval());
+    
+    // Slowest below fastest is raised to it, no back off
+    setPollLimits(100, 50);
+    pollActivity();
+    idle();
+    TEST_ASSERT_EQUAL_UINT16(100, getPollInterval());
+    TEST_ASSERT_EQUAL_UINT16(100, nextPoll());
+}
+
 // Note: The actual readRFID function requires hardware interaction
 // and would need hardware mocking or integration testing for full coverage.
 // These tests validate the API contract and data types.
@@ -0,0 +1,215 @@
+/**
+ * Unit Tests for RTC Module
+ * 
+ * Tests the schedule entry encoding, and the clock, drift and schedule
+ * lookup driven by the mock millisecond counter and EEPROM
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before rtc.h
+#include "rtc.h"
+#include "cat.h"
+#include "config.h"        // Used by rtc.c
+#include "peripherials.h"  // Used by cat.c
+#include "adc.h"           // Used by peripherials.c
+#include "timer.h"         // Used by peripherials.c
+
+// Test fixtures
+void setUp(void)
+{
+    // This is run before each test
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Schedule entries round trip
+ */
+void test_schedule_entry_encoding(void)
+{
+    // Curfew (closed, mode 2) at 21:00
+    uint16_t curfew = SCHED_ENTRY(21 * 60, 2);
+    TEST_ASSERT_EQUAL_UINT16(1260, SCHED_MINUTE(curfew));
+    TEST_ASSERT_EQUAL_UINT8(2, SCHED_MODE(curfew));
+    
+    // Open (normal, mode 0) at 07:00
+    uint16_t morning = SCHED_ENTRY(7 * 60, 0);
+    TEST_ASSERT_EQUAL_UINT16(420, SCHED_MINUTE(morning));
+    TEST_ASSERT_EQUAL_UINT8(0, SCHED_MODE(morning));
+    
+    // Last minute of the day with the highest mode
+    uint16_t last = SCHED_ENTRY(MINUTES_PER_DAY - 1, 6);
+    TEST_ASSERT_EQUAL_UINT16(1439, SCHED_MINUTE(last));
+    TEST_ASSERT_EQUAL_UINT8(6, SCHED_MODE(last));
+}
+
+/**
+ * Test: Unprogrammed entries never match a minute of the day
+ */
+void test_schedule_unprogrammed(void)
+{
+    TEST_ASSERT_TRUE(SCHED_MINUTE(0xFFFF) >= MINUTES_PER_DAY);
+    TEST_ASSERT_NOT_EQUAL(SCHED_NONE, SCHED_MODE(0xFFFF));
+    TEST_ASSERT_TRUE(SCHED_NONE > 6);
+}
+
+/**
+ * Test: Schedule fits the configuration area
+ */
+void test_schedule_location(void)
+{
+    // Entries are words after the other settings
+    TEST_ASSERT_GREATER_THAN(RTC_DRIFT_CFG, SCHEDULE_CFG);
+    TEST_ASSERT_TRUE((SCHEDULE_CFG + SCHEDULE_ENTRIES) * 2 <= CAT_OFFSET);
+}
+
+// 2024-01-01 00:00:00 local time
+#define DAY_START 1704067200UL
+
+/**
+ * Let the tick advance and the clock catch up
+ * @param ms Elapsed milliseconds
+ * @return updateRTC() result
+ */
+static bool elapse(uint32_t ms)
+{
+    mockMillis += ms;
+    return updateRTC();
+}
+
+/**
+ * Test: Setting the time reports the current minute once
+ */
+void test_rtc_set_time(void)
+{
+    setDrift(0);
+    setTime(DAY_START + 21UL * 3600 + 30 * 60 + 15);
+    TEST_ASSERT_TRUE(timeValid());
+    TEST_ASSERT_EQUAL_UINT16(21 * 60 + 30, getMinuteOfDay());
+    
+    // The schedule is checked right away, then at the next minute
+    TEST_ASSERT_TRUE(updateRTC());
+    TEST_ASSERT_FALSE(updateRTC());
+    TEST_ASSERT_FALSE(elapse(44999));
+    TEST_ASSERT_TRUE(elapse(1));
+    TEST_ASSERT_EQUAL_UINT16(21 * 60 + 31, getMinuteOfDay());
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + 21UL * 3600 + 31 * 60, getTime());
+}
+
+/**
+ * Test: Minute of day wraps at midnight
+ */
+void test_rtc_midnight(void)
+{
+    setDrift(0);
+    setTime(DAY_START + SECONDS_PER_DAY - 1);
+    updateRTC();
+    TEST_ASSERT_EQUAL_UINT16(MINUTES_PER_DAY - 1, getMinuteOfDay());
+    TEST_ASSERT_TRUE(elapse(1000));
+    TEST_ASSERT_EQUAL_UINT16(0, getMinuteOfDay());
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + SECONDS_PER_DAY, getTime());
+}
+
+/**
+ * Test: Drift correction in ppm
+ */
+void test_rtc_drift(void)
+{
+    // Tick 1000ppm fast: 1001 counted ms per real second, the extra ms is
+    // taken back once a second was counted
+    setTime(DAY_START);
+    setDrift(1000);
+    updateRTC();
+    elapse(999UL * 1001 + 1000 - 1);
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + 999, getTime());
+    elapse(1);
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + 1000, getTime());
+    
+    // Tick 1000ppm slow: 999 counted ms per real second
+    setTime(DAY_START);
+    setDrift(-1000);
+    updateRTC();
+    elapse(999UL * 999 + 1000 - 1);
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + 999, getTime());
+    elapse(1);
+    TEST_ASSERT_EQUAL_UINT32(DAY_START + 1000, getTime());
+    TEST_ASSERT_EQUAL_INT16(-1000, getDrift());
+    setDrift(0);
+}
+
+/**
+ * Test: An entry is reported once, from its minute
+ */
+void test_rtc_scheduled_mode(void)
+{
+    mockEepromErase();
+    setDrift(0);
+    setConfiguration(SCHEDULE_CFG + 3, SCHED_ENTRY(21 * 60, 2));
+    setConfiguration(SCHEDULE_CFG + 5, SCHED_ENTRY(7 * 60, 0));
+    
+    // The morning entry is in force at 20:59
+    setTime(DAY_START + 20UL * 3600 + 59 * 60 + 59);
+    TEST_ASSERT_TRUE(updateRTC());
+    TEST_ASSERT_EQUAL_UINT8(0, scheduledMode());
+    TEST_ASSERT_EQUAL_UINT8(SCHED_NONE, scheduledMode());
+    TEST_ASSERT_TRUE(elapse(1000));
+    TEST_ASSERT_EQUAL_UINT8(2, scheduledMode());
+    TEST_ASSERT_TRUE(elapse(60000));
+    TEST_ASSERT_EQUAL_UINT8(SCHED_NONE, scheduledMode());
+    
+    // Again the next day
+    TEST_ASSERT_TRUE(elapse((MINUTES_PER_DAY - 1) * 60000UL));
+    TEST_ASSERT_EQUAL_UINT8(2, scheduledMode());
+}
+
+/**
+ * Test: An entry passed while the main loop was blocked is applied late
+ */
+void test_rtc_scheduled_late(void)
+{
+    mockEepromErase();
+    setDrift(0);
+    setConfiguration(SCHEDULE_CFG, SCHED_ENTRY(21 * 60, 2));
+    setTime(DAY_START + 20UL * 3600 + 59 * 60);
+    updateRTC();
+    TEST_ASSERT_EQUAL_UINT8(2, scheduledMode());
+    
+    // Blocked from 20:59 to 21:02, only one new minute is reported
+    setConfiguration(SCHEDULE_CFG + 1, SCHED_ENTRY(21 * 60 + 1, 3));
+    TEST_ASSERT_TRUE(elapse(3 * 60000UL));
+    TEST_ASSERT_EQUAL_UINT8(3, scheduledMode());
+    TEST_ASSERT_FALSE(updateRTC());
+    TEST_ASSERT_TRUE(elapse(60000));
+    TEST_ASSERT_EQUAL_UINT8(SCHED_NONE, scheduledMode());
+}
+
+/**
+ * Test: Setting the time applies the entry in force, even yesterday's
+ */
+void test_rtc_scheduled_set_time(void)
+{
+    mockEepromErase();
+    setDrift(0);
+    setConfiguration(SCHEDULE_CFG, SCHED_ENTRY(21 * 60, 2));
+    setConfiguration(SCHEDULE_CFG + 1, SCHED_ENTRY(22 * 60, 3));
+    
+    // Set after both entries
+    setTime(DAY_START + 23UL * 3600);
+    TEST_ASSERT_TRUE(updateRTC());
+    TEST_ASSERT_EQUAL_UINT8(3, scheduledMode());
+    
+    // Set between them, then before the first: the night entry of the
+    // day before is in force
+    setTime(DAY_START + 21UL * 3600 + 30 * 60);
+    TEST_ASSERT_EQUAL_UINT8(2, scheduledMode());
+    setTime(DAY_START + SECONDS_PER_DAY + 6UL * 3600);
+    TEST_ASSERT_EQUAL_UINT8(3, scheduledMode());
+    
+    // Nothing scheduled
+    mockEepromErase();
+    setTime(DAY_START);
+    TEST_ASSERT_EQUAL_UINT8(SCHED_NONE, scheduledMode());
+}
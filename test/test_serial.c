@@ -1,18 +1,38 @@
 /**
  * Unit Tests for Serial Module
  * 
- * Tests the serial communication definitions and ring buffer structure
- * Note: UART hardware functions are tested via hardware/integration tests
+ * Tests the serial communication definitions, the ring buffer structure
+ * and the text emitters, read back from the transmit ring
+ * Transmit ring and auto-baud paths run against the register mock, UART
+ * timing is tested via hardware/integration tests
  */
 
 #include "unity.h"
 #include "xc_hardware_mock.h"  // Must be included before serial.h
 #include "serial.h"
+#include "timer.h"     // Used by serial.c
 
 // Test fixtures
 void setUp(void)
 {
-    // This is run before each test
+    txBuffer.rIndex = 0;
+    txBuffer.wIndex = 0;
+    setProtocol(PROTO_TEXT);
+    setOutputMask(OUT_ALL);
+}
+
+//Characters queued since the last call, as a string
+static char sentText[TX_BUFFER + 1];
+
+static const char* sent(void)
+{
+    uint8_t n = 0;
+    while(txBuffer.rIndex != txBuffer.wIndex){
+        sentText[n++] = (char)txBuffer.buffer[txBuffer.rIndex];
+        txBuffer.rIndex = (txBuffer.rIndex + 1) & (TX_BUFFER - 1);
+    }
+    sentText[n] = '\0';
+    return sentText;
 }
 
 void tearDown(void)
@@ -25,8 +45,8 @@ void tearDown(void)
  */
 void test_serial_buffer_size(void)
 {
-    // Buffer should be 16 bytes as defined
-    TEST_ASSERT_EQUAL(16, SER_BUFFER);
+    // Buffer should be 32 bytes as defined
+    TEST_ASSERT_EQUAL(32, SER_BUFFER);
 }
 
 /**
@@ -87,14 +107,14 @@ void test_ring_buffer_data(void)
  */
 void test_uart_divider(void)
 {
-    // DIVIDER should be calculated for 9600 baud
-    // Formula: _XTAL_FREQ/(16 * 9600) - 1
-    // With test mock _XTAL_FREQ=19660800: 19660800/(16*9600) - 1 = 127.0 = 127
-    // Note: Actual hardware uses 19600000 which gives 126.7 ≈ 127
+    // DIVIDER should be calculated for 9600 baud with BRG16 and BRGH
+    // Formula: (_XTAL_FREQ + 2*9600)/(4 * 9600) - 1, rounded
+    // With test mock _XTAL_FREQ=19660800: 19680000/38400 - 1 = 511
+    // Note: Actual hardware uses 19600000 which gives 509
     
     #ifdef _XTAL_FREQ
-        int calculated = (int)(_XTAL_FREQ/(16UL * BAUD_RATE) - 1);
-        TEST_ASSERT_EQUAL(calculated, DIVIDER);
+        TEST_ASSERT_EQUAL(511, DIVIDER);
+        TEST_ASSERT_EQUAL(509, BAUD_DIVIDER(19600000UL, BAUD_RATE));
     #endif
 }
 
@@ -218,7 +238,7 @@ void test_ring_buffer_capacity(void)
     
     // Effective capacity is SER_BUFFER - 1
     uint8_t effective_capacity = SER_BUFFER - 1;
-    TEST_ASSERT_EQUAL_UINT8(15, effective_capacity);
+    TEST_ASSERT_EQUAL_UINT8(31, effective_capacity);
 }
 
 /**
@@ -329,33 +349,136 @@ void test_ring_buffer_available_space(void)
  */
 void test_serial_buffer_size_power_of_two(void)
 {
-    // 16 is a power of 2, making modulo operations efficient
-    TEST_ASSERT_EQUAL(16, SER_BUFFER);
+    // 32 is a power of 2, indexes wrap with a mask
+    TEST_ASSERT_EQUAL(32, SER_BUFFER);
     
     // Verify it's a power of 2
     TEST_ASSERT_EQUAL(0, SER_BUFFER & (SER_BUFFER - 1));
 }
 
+/**
+ * Test: RTS thresholds leave room and hysteresis
+ */
+void test_rx_rts_thresholds(void)
+{
+    // Raised before the ring is full, room for late bytes from the host
+    TEST_ASSERT_TRUE(RX_RTS_HIGH < SER_BUFFER - 1);
+    TEST_ASSERT_TRUE(RX_RTS_LOW < RX_RTS_HIGH);
+    
+    // Waiting count wraps with the mask
+    uint8_t rIndex = 3;
+    uint8_t uIndex = SER_BUFFER - 5;
+    TEST_ASSERT_EQUAL_UINT8(8, (uint8_t)(rIndex - uIndex) & (SER_BUFFER - 1));
+}
+
+/**
+ * Test: Transmit ring wraps with a mask
+ */
+void test_tx_buffer_wrap(void)
+{
+    struct TxBuffer testBuffer;
+    
+    TEST_ASSERT_EQUAL(0, TX_BUFFER & (TX_BUFFER - 1));
+    TEST_ASSERT_EQUAL_size_t(TX_BUFFER, sizeof(testBuffer.buffer));
+    
+    // Full when the next write slot is the next character to send
+    testBuffer.rIndex = 0;
+    testBuffer.wIndex = TX_BUFFER - 1;
+    uint8_t next = (testBuffer.wIndex + 1) & (TX_BUFFER - 1);
+    TEST_ASSERT_EQUAL_UINT8(testBuffer.rIndex, next);
+    
+    // Policies are distinct
+    TEST_ASSERT_NOT_EQUAL(TX_BLOCK, TX_DROP);
+}
+
+/**
+ * Test: Hexadecimal output matches printf's %02X and %04X
+ */
+void test_put_hex(void)
+{
+    putHex8(0x5C);
+    TEST_ASSERT_EQUAL_STRING("5C", sent());
+    putHex8(0x0A);
+    TEST_ASSERT_EQUAL_STRING("0A", sent());
+    putHex16(0x0F00);
+    TEST_ASSERT_EQUAL_STRING("0F00", sent());
+    putHex16(0xFFFF);
+    TEST_ASSERT_EQUAL_STRING("FFFF", sent());
+}
+
+/**
+ * Test: 16-bit decimal output matches printf's %u
+ */
+void test_put_uint(void)
+{
+    putUint(0);
+    TEST_ASSERT_EQUAL_STRING("0", sent());
+    putUint(7);
+    TEST_ASSERT_EQUAL_STRING("7", sent());
+    putUint(10);
+    TEST_ASSERT_EQUAL_STRING("10", sent());
+    putUint(1000);
+    TEST_ASSERT_EQUAL_STRING("1000", sent());
+    putUint(30009);
+    TEST_ASSERT_EQUAL_STRING("30009", sent());
+    putUint(65535);
+    TEST_ASSERT_EQUAL_STRING("65535", sent());
+}
+
+/**
+ * Test: 32-bit decimal output matches printf's %lu
+ */
+void test_put_ulong(void)
+{
+    putUlong(0);
+    TEST_ASSERT_EQUAL_STRING("0", sent());
+    putUlong(86400);
+    TEST_ASSERT_EQUAL_STRING("86400", sent());
+    putUlong(1000000000UL);
+    TEST_ASSERT_EQUAL_STRING("1000000000", sent());
+    putUlong(1704067200UL);
+    TEST_ASSERT_EQUAL_STRING("1704067200", sent());
+    putUlong(4294967295UL);
+    TEST_ASSERT_EQUAL_STRING("4294967295", sent());
+}
+
 /**
  * Test: Baud rate divider calculation correctness
  */
 void test_baud_rate_divider_calculation(void)
 {
-    // DIVIDER = (_XTAL_FREQ / (16 * BAUD_RATE)) - 1
+    // DIVIDER = (_XTAL_FREQ / (4 * BAUD_RATE)) - 1, rounded
     // NOTE: Test uses _XTAL_FREQ=19660800 (defined in project.yml for testing)
     // Hardware uses _XTAL_FREQ=19600000 (actual crystal frequency)
-    // Both values calculate to DIVIDER=127 for 9600 baud
     
     #ifdef _XTAL_FREQ
-    int calculated = (int)(_XTAL_FREQ / (16UL * BAUD_RATE) - 1);
-    TEST_ASSERT_EQUAL(calculated, DIVIDER);
+    uint32_t actual = BAUD_ACTUAL(_XTAL_FREQ, DIVIDER);
+    TEST_ASSERT_UINT32_WITHIN(BAUD_RATE / 100, BAUD_RATE, actual);
     
-    // Verify it's within valid range for 8-bit register
-    TEST_ASSERT_TRUE(DIVIDER <= 255);
-    TEST_ASSERT_TRUE(DIVIDER >= 0);
+    // Verify it's within valid range for the 16-bit register pair
+    TEST_ASSERT_TRUE(DIVIDER <= 0xFFFF);
+    TEST_ASSERT_TRUE(DIVIDER > 0);
     #endif
 }
 
+/**
+ * Test: Rates up to 115200 are reachable from the crystal
+ */
+void test_baud_rate_error(void)
+{
+    // 19600000 / (4 * 43) = 113953 bps, 1.08% low
+    TEST_ASSERT_EQUAL(42, BAUD_DIVIDER(19600000UL, 115200UL));
+    TEST_ASSERT_EQUAL(113953, BAUD_ACTUAL(19600000UL, 42));
+    TEST_ASSERT_EQUAL(108, BAUD_ERROR(19600000UL, 115200UL));
+    TEST_ASSERT_TRUE(BAUD_ERROR(19600000UL, 115200UL) <= BAUD_ERROR_MAX);
+    
+    // 9600 at the real crystal, 9607 bps is 0.07% high
+    TEST_ASSERT_EQUAL(7, BAUD_ERROR(19600000UL, 9600UL));
+    
+    // 115200 is out of reach of the 4 MHz internal oscillator
+    TEST_ASSERT_TRUE(BAUD_ERROR(4000000UL, 115200UL) > BAUD_ERROR_MAX);
+}
+
 /**
  * Test: Ring buffer used space calculation
  */
@@ -419,6 +542,82 @@ void test_uart_errors_independence(void)
     TEST_ASSERT_EQUAL_UINT8(30, errors.bufferOverflows);
 }
 
-// Note: Hardware-dependent functions (initSerial, putch, getByte, etc.)
+/**
+ * Test: Output classes are muted one bit at a time
+ */
+void test_output_classes(void)
+{
+    TEST_ASSERT_TRUE(outputEnabled(OUT_ECHO));
+    TEST_ASSERT_TRUE(outputEnabled(OUT_STATS));
+
+    setOutputMask(OUT_CAT | OUT_ERROR);
+    TEST_ASSERT_TRUE(outputEnabled(OUT_CAT));
+    TEST_ASSERT_TRUE(outputEnabled(OUT_ERROR));
+    TEST_ASSERT_FALSE(outputEnabled(OUT_ECHO));
+    TEST_ASSERT_FALSE(outputEnabled(OUT_TRACE));
+    TEST_ASSERT_FALSE(outputEnabled(OUT_STATUS));
+    TEST_ASSERT_FALSE(outputEnabled(OUT_STATS));
+
+    setOutputMask(0);
+    TEST_ASSERT_FALSE(outputEnabled(OUT_CAT));
+}
+
+/**
+ * Test: Signed and two digit decimal output
+ */
+void test_put_int(void)
+{
+    putInt(0);
+    TEST_ASSERT_EQUAL_STRING("0", sent());
+    putInt(-1);
+    TEST_ASSERT_EQUAL_STRING("-1", sent());
+    putInt(1000);
+    TEST_ASSERT_EQUAL_STRING("1000", sent());
+    putInt(-1000);
+    TEST_ASSERT_EQUAL_STRING("-1000", sent());
+    putInt(INT16_MIN);
+    TEST_ASSERT_EQUAL_STRING("-32768", sent());
+    putDec2(0);
+    TEST_ASSERT_EQUAL_STRING("00", sent());
+    putDec2(7);
+    TEST_ASSERT_EQUAL_STRING("07", sent());
+    putDec2(59);
+    TEST_ASSERT_EQUAL_STRING("59", sent());
+}
+
+/**
+ * Test: Output during auto-baud is dropped instead of waiting forever
+ */
+void test_put_raw_during_auto_baud(void)
+{
+    // Transmit shift register empty, interrupts enabled
+    TXSTAbits.TRMT = 1;
+    INTCONbits.GIE = 1;
+    txBuffer.rIndex = 0;
+    txBuffer.wIndex = 0;
+    uartErrors.txDrops = 0;
+    setTxPolicy(TX_BLOCK);
+    startAutoBaud();
+    TEST_ASSERT_TRUE(autoBaudPending());
+    
+    // The ring is not drained, the extra characters are counted
+    TXIE = 0;
+    for(uint8_t i=0;i<TX_BUFFER+8;++i){
+        putRaw(i);
+    }
+    TEST_ASSERT_EQUAL_UINT16(9, uartErrors.txDrops);
+    TEST_ASSERT_EQUAL_UINT8(0, TXIE);
+    TEST_ASSERT_TRUE(txPending());
+    
+    // Timeout restores the rate and releases the transmit interrupt
+    timerStop(TIMER_BAUD);
+    BAUDCTLbits.ABDEN = 1;
+    TEST_ASSERT_EQUAL_UINT8(BAUD_FAILED, serviceAutoBaud());
+    TEST_ASSERT_FALSE(autoBaudPending());
+    TEST_ASSERT_EQUAL_UINT8(1, TXIE);
+    INTCONbits.GIE = 0;
+}
+
+// Note: Hardware-dependent functions (initSerial, the UART interrupt)
 // would require hardware mocking for full functional testing.
 // These tests validate data structures and calculations.
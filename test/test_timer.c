@@ -0,0 +1,143 @@
+/**
+ * Unit Tests for Timer Module
+ * 
+ * Tests the software timer slots, flags and count down
+ * The tick interrupt is replaced by direct tickTimers() calls
+ */
+
+#include "unity.h"
+#include "xc_hardware_mock.h"  // Must be included before timer.h
+#include "timer.h"
+#include <stddef.h>
+
+// Test fixtures
+void setUp(void)
+{
+    // This is run before each test
+}
+
+void tearDown(void)
+{
+    // This is run after each test
+}
+
+/**
+ * Test: Every user has its own slot inside the pool
+ */
+void test_timer_slots(void)
+{
+    uint8_t slots[] = {TIMER_LIGHT, TIMER_LEARN, TIMER_OPEN,
+                       TIMER_SERIAL, TIMER_RFID_SYNC, TIMER_RFID_EDGE,
+                       TIMER_LATCH, TIMER_BAUD, TIMER_STREAM};
+    
+    TEST_ASSERT_EQUAL(TIMER_COUNT, sizeof(slots));
+    for (size_t i = 0; i < sizeof(slots); i++) {
+        TEST_ASSERT_LESS_THAN(TIMER_COUNT, slots[i]);
+        for (size_t j = i + 1; j < sizeof(slots); j++) {
+            TEST_ASSERT_NOT_EQUAL(slots[i], slots[j]);
+        }
+    }
+}
+
+/**
+ * Test: Flags are separate bits
+ */
+void test_timer_flags(void)
+{
+    TEST_ASSERT_EQUAL(0, TIMER_RUNNING & TIMER_PERIODIC);
+    TEST_ASSERT_EQUAL(0, TIMER_RUNNING & TIMER_EXPIRED);
+    TEST_ASSERT_EQUAL(0, TIMER_PERIODIC & TIMER_EXPIRED);
+}
+
+/**
+ * Test: A one-shot timer expires once after its duration
+ */
+void test_timer_one_shot(void)
+{
+    timerStart(TIMER_OPEN, 5, false);
+    TEST_ASSERT_TRUE(timerRunning(TIMER_OPEN));
+    tickTimers(4);
+    TEST_ASSERT_TRUE(timerRunning(TIMER_OPEN));
+    TEST_ASSERT_EQUAL_UINT16(1, timerRemaining(TIMER_OPEN));
+    TEST_ASSERT_FALSE(timerExpired(TIMER_OPEN));
+    
+    tickTimers(1);
+    TEST_ASSERT_FALSE(timerRunning(TIMER_OPEN));
+    TEST_ASSERT_EQUAL_UINT16(0, timerRemaining(TIMER_OPEN));
+    // The expiry is reported once
+    TEST_ASSERT_TRUE(timerExpired(TIMER_OPEN));
+    TEST_ASSERT_FALSE(timerExpired(TIMER_OPEN));
+    tickTimers(100);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_OPEN));
+}
+
+/**
+ * Test: A periodic timer reloads, missed periods give one expiry
+ */
+void test_timer_periodic(void)
+{
+    timerStart(TIMER_STREAM, 10, true);
+    tickTimers(10);
+    TEST_ASSERT_TRUE(timerExpired(TIMER_STREAM));
+    TEST_ASSERT_TRUE(timerRunning(TIMER_STREAM));
+    TEST_ASSERT_EQUAL_UINT16(10, timerRemaining(TIMER_STREAM));
+    
+    // Several periods at once (Sleep) are merged
+    tickTimers(35);
+    TEST_ASSERT_TRUE(timerExpired(TIMER_STREAM));
+    TEST_ASSERT_FALSE(timerExpired(TIMER_STREAM));
+    TEST_ASSERT_EQUAL_UINT16(10, timerRemaining(TIMER_STREAM));
+    timerStop(TIMER_STREAM);
+}
+
+/**
+ * Test: Stop and restart
+ */
+void test_timer_stop_restart(void)
+{
+    // Stopping drops a pending expiry
+    timerStart(TIMER_LIGHT, 3, false);
+    tickTimers(3);
+    timerStop(TIMER_LIGHT);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_LIGHT));
+    TEST_ASSERT_FALSE(timerRunning(TIMER_LIGHT));
+    tickTimers(10);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_LIGHT));
+    
+    // Restarting reloads the full duration, 0 is one tick
+    timerStart(TIMER_LIGHT, 0, false);
+    TEST_ASSERT_EQUAL_UINT16(1, timerRemaining(TIMER_LIGHT));
+    timerStart(TIMER_LIGHT, 30000, false);
+    tickTimers(29999);
+    TEST_ASSERT_TRUE(timerRunning(TIMER_LIGHT));
+    timerStart(TIMER_LIGHT, 30000, false);
+    TEST_ASSERT_EQUAL_UINT16(30000, timerRemaining(TIMER_LIGHT));
+    timerStop(TIMER_LIGHT);
+}
+
+static uint8_t callbackCount = 0;
+
+static void countCallback(void)
+{
+    ++callbackCount;
+}
+
+/**
+ * Test: Callbacks run from serviceTimers() and consume the expiry
+ */
+void test_timer_callback(void)
+{
+    callbackCount = 0;
+    timerSetCallback(TIMER_LEARN, countCallback);
+    timerStart(TIMER_LEARN, 2, false);
+    serviceTimers();
+    TEST_ASSERT_EQUAL_UINT8(0, callbackCount);
+    
+    tickTimers(2);
+    serviceTimers();
+    TEST_ASSERT_EQUAL_UINT8(1, callbackCount);
+    TEST_ASSERT_FALSE(timerExpired(TIMER_LEARN));
+    serviceTimers();
+    TEST_ASSERT_EQUAL_UINT8(1, callbackCount);
+    timerSetCallback(TIMER_LEARN, NULL);
+}
@@ -0,0 +1,88 @@
+/*
+ * File:   timer.c
+ * Comments: Software timers counted down by the millisecond tick
+ */
+
+#include <xc.h>
+#include <stddef.h>
+#include "timer.h"
+
+volatile struct SoftTimer timers[TIMER_COUNT];
+//Callbacks are only used from the main loop
+static timerCallback callbacks[TIMER_COUNT];
+
+void timerStart(uint8_t id, uint16_t ms, bool periodic)
+{
+    if(ms == 0){
+        ms = 1;
+    }
+    CCP2IE = 0;
+    timers[id].remaining = ms;
+    timers[id].period = ms;
+    timers[id].flags = periodic ? (TIMER_RUNNING | TIMER_PERIODIC) : TIMER_RUNNING;
+    CCP2IE = 1;
+}
+
+void timerStop(uint8_t id)
+{
+    timers[id].flags = 0;
+}
+
+bool timerExpired(uint8_t id)
+{
+    if(!(timers[id].flags & TIMER_EXPIRED)){
+        return false;
+    }
+    CCP2IE = 0;
+    timers[id].flags &= ~TIMER_EXPIRED;
+    CCP2IE = 1;
+    return true;
+}
+
+bool timerRunning(uint8_t id)
+{
+    return (timers[id].flags & TIMER_RUNNING) != 0;
+}
+
+uint16_t timerRemaining(uint8_t id)
+{
+    uint16_t ret = 0;
+    CCP2IE = 0;
+    if(timers[id].flags & TIMER_RUNNING){
+        ret = timers[id].remaining;
+    }
+    CCP2IE = 1;
+    return ret;
+}
+
+void timerSetCallback(uint8_t id, timerCallback cb)
+{
+    callbacks[id] = cb;
+}
+
+void serviceTimers(void)
+{
+    for(uint8_t i=0;i<TIMER_COUNT;++i){
+        if((callbacks[i] != NULL) && timerExpired(i)){
+            callbacks[i]();
+        }
+    }
+}
+
+void tickTimers(uint16_t ms)
+{
+    for(uint8_t i=0;i<TIMER_COUNT;++i){
+        if(timers[i].flags & TIMER_RUNNING){
+            if(timers[i].remaining > ms){
+                timers[i].remaining -= ms;
+            }else if(timers[i].flags & TIMER_PERIODIC){
+                //Missed periods (Sleep) are merged into one expiry
+                timers[i].remaining = timers[i].period;
+                timers[i].flags |= TIMER_EXPIRED;
+            }else{
+                timers[i].remaining = 0;
+                timers[i].flags = TIMER_EXPIRED;
+            }
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/* 
+ * File:   timer.h
+ * Comments: Software timers counted down by the millisecond tick
+ * Revision history: 
+ */
+
+// This is a guard condition so that contents of this file are not included
+// more than once.  
+#ifndef TIMER_INCLUDED_H
+#define	TIMER_INCLUDED_H
+
+#include <xc.h> // include processor files - each processor file is guarded.  
+#include <stdbool.h>
+#include <stdint.h>
+
+// Timer slots, one per user
+#define TIMER_LIGHT 0       // Light sensor read period
+#define TIMER_LEARN 1       // Learn mode window
+#define TIMER_OPEN 2        // Entrance open window
+#define TIMER_SERIAL 3      // Serial byte timeout
+#define TIMER_RFID_SYNC 4   // RFID header search
+#define TIMER_RFID_EDGE 5   // RFID edge wait
+#define TIMER_LATCH 6       // Latch solenoid pulse
+#define TIMER_BAUD 7        // Auto-baud detection
+#define TIMER_STREAM 8      // Telemetry push period
+#define TIMER_COUNT 9
+
+// Timer flags
+#define TIMER_RUNNING 0x1
+#define TIMER_PERIODIC 0x2
+#define TIMER_EXPIRED 0x4
+
+typedef void (*timerCallback)(void);
+
+// Timer state, counted down by the tick interrupt
+struct SoftTimer{
+    uint16_t remaining;     //Ticks before expiry
+    uint16_t period;        //Reload of a periodic timer
+    uint8_t flags;
+};
+extern volatile struct SoftTimer timers[TIMER_COUNT];
+
+/**
+ * Start or restart a timer
+ * The first expiry is between ms-1 and ms milliseconds away, as the
+ * current tick is already running
+ * @param id Timer slot (TIMER_*)
+ * @param ms Duration (1-65535)
+ * @param periodic true to restart automatically on expiry
+ */
+void timerStart(uint8_t id, uint16_t ms, bool periodic);
+
+/**
+ * Stop a timer and clear its expiry
+ * @param id Timer slot
+ */
+void timerStop(uint8_t id);
+
+/**
+ * Check and clear the expiry of a timer
+ * @param id Timer slot
+ * @return true if the timer expired since the last call
+ */
+bool timerExpired(uint8_t id);
+
+/**
+ * Check if a one-shot timer is still counting
+ * @param id Timer slot
+ * @return true while running
+ */
+bool timerRunning(uint8_t id);
+
+/**
+ * Get time before the next expiry
+ * @param id Timer slot
+ * @return Milliseconds, 0 if stopped
+ */
+uint16_t timerRemaining(uint8_t id);
+
+/**
+ * Call a function from serviceTimers() when the timer expires
+ * The expiry is consumed by the call
+ * @param id Timer slot
+ * @param cb Function to call, NULL to poll timerExpired() instead
+ */
+void timerSetCallback(uint8_t id, timerCallback cb);
+
+/**
+ * Run the callbacks of expired timers
+ * Called from the main loop, never from the interrupt
+ */
+void serviceTimers(void);
+
+/**
+ * Count the timers down (ISR only)
+ * @param ms Elapsed milliseconds, 1 for a tick, more after Sleep
+ */
+void tickTimers(uint16_t ms);
+
+#endif	/* TIMER_INCLUDED_H */